@@ -66,7 +66,12 @@ CalcTreeView::create_column_name(Glib::ustring name, Gtk::TreeModelColumn<Glib::
 			Gtk::TreeModel::Row row = *iter;
 			Glib::ustring varName = row[col];
 			//std::cout << "Got varName" << varName << std::endl;
-			if (datas == "") {
+			if (m_evalContext->is_constant(varName)) {
+				m_calcppWin->show_error(psc::fmt::vformat(
+                    _("{} is a constant")
+                    , psc::fmt::make_format_args(varName)));
+			}
+			else if (datas == "") {
 				m_evalContext->remove(varName);
 			}
 			else {
@@ -98,9 +103,17 @@ CalcTreeView::value_cell_data_func(Gtk::CellRenderer* cell, const Gtk::TreeModel
 			row.get_value(model_column, value);
 
 			//Convert it to a string representation:
-			auto output_format = m_evalContext->get_output_format();
-			auto str = output_format->format(value);
-			pTextRenderer->property_text() = str;
+			if (row[m_evalContext->m_variable_columns.m_isList]) {
+				auto count = static_cast<size_t>(value);
+				pTextRenderer->property_text() = psc::fmt::vformat(
+                    _("[{} values]")
+                    , psc::fmt::make_format_args(count));
+			}
+			else {
+				auto output_format = m_evalContext->get_output_format();
+				auto str = output_format->format(value);
+				pTextRenderer->property_text() = str;
+			}
 		}
 	}
 }
@@ -128,10 +141,17 @@ CalcTreeView::create_column_value(Glib::ustring name, Gtk::TreeModelColumn<doubl
 			Gtk::TreeIter iter = model->get_iter(tPath);
 			std::string::size_type end;
 			double val;
-			if (m_evalContext->get_output_format()->parse(data, val, &end)) {	// uniform number conversion handling
+			if (m_evalContext->get_output_format()->parse(data.raw(), val, &end)) {	// uniform number conversion handling
 				Gtk::TreeModel::Row row = *iter;
 				Glib::ustring varName = row[m_evalContext->m_variable_columns.m_name];
-				m_evalContext->set_value(varName, val);
+				if (m_evalContext->is_constant(varName)) {
+					m_calcppWin->show_error(psc::fmt::vformat(
+                        _("{} is a constant")
+                        , psc::fmt::make_format_args(varName)));
+				}
+				else {
+					m_evalContext->set_value(varName, val);
+				}
 			}
 			else {
 				m_calcppWin->show_error(psc::fmt::vformat(
@@ -543,6 +543,7 @@ CalcppWin::eval(Glib::ustring text)
         StringUtils::split(text, '\n', lines);
         double val;
         bool result = false;
+        Syntax syntax(outputForm, m_evalContext);
         for (Glib::ustring& line : lines) {
             auto sline = line;
             StringUtils::trim(sline);
@@ -550,12 +551,12 @@ CalcppWin::eval(Glib::ustring text)
 #               ifdef DEBUG
                     std::cout << "eval \"" << sline << "\"" << std::endl;
 #               endif
-                Syntax syntax(outputForm, m_evalContext);
 				auto stack = syntax.parse(line);
 				val = m_evalContext->eval(stack);
                 result = true;
             }
         }
+        m_evalContext->flush();   // show the variables once for all lines
         if (result) {         // only output last result for not clutter view
             Glib::ustring res = outputForm->format(val);
 			res += "\n";
@@ -28,7 +28,7 @@
 
 class CalcppApp;
 class Syntax;
-class Token;
+struct Token;
 
 /*
  * Window that is the central visible piece of application,
@@ -16,74 +16,54 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <math.h>
 #include <iostream>
-#include <StringUtils.hpp>
 #include <psc_i18n.hpp>
 
 #include "EvalContext.hpp"
+#include "UserFunction.hpp"
+#include "Syntax.hpp"
 #include "calcpp_config.h"
 
 EvalContext::EvalContext()
 : Glib::ObjectBase(typeid (EvalContext))
+, Evaluator()
 , m_variable_columns()
-, m_angleConv{RadianConversion::get_conversion("")} // use search with invalid key so we wont create addition references
-, m_output_format{OutformDecimal::get_form("")} // as above, avoid the hassle to correctly free it afterwards
-, property_angle_conv_id_(*this, ANGLE_CONV_ID_PROPERTY, m_angleConv->get_id())
-, output_format_id_(*this, OUTPUT_FORMAT_ID_PROPERTY, m_output_format->get_id())
-, m_variables()
+, property_angle_conv_id_(*this, ANGLE_CONV_ID_PROPERTY, get_angle_conv()->get_id())
+, output_format_id_(*this, OUTPUT_FORMAT_ID_PROPERTY, get_output_format()->get_id())
 , m_list{Gtk::ListStore::create(m_variable_columns)}
-, m_functionMap{
-          {"sqrt",   std::make_shared<FunctionSqrt>()}
-    	, {"cbrt",   std::make_shared<FunctionCbrt>()}
-        , {"exp",    std::make_shared<FunctionExp>()}
-        , {"sin",    std::make_shared<FunctionSin>()}
-        , {"cos",    std::make_shared<FunctionCos>()}
-        , {"tan",    std::make_shared<FunctionTan>()}
-        , {"log2",   std::make_shared<FunctionLog2>()}
-        , {"abs",    std::make_shared<FunctionAbs>()}
-        , {"fac",    std::make_shared<FunctionFactorial>()}
-    }
 {
-    auto functLog = std::make_shared<FunctionLog>();
-    m_functionMap.insert(std::make_pair("log",    functLog));
-    m_functionMap.insert(std::make_pair("ln",     functLog));
-    auto functAsin = std::make_shared<FunctionAsin>();
-    m_functionMap.insert(std::make_pair("asin",   functAsin));
-    m_functionMap.insert(std::make_pair("arcsin", functAsin));
-    auto functAcos = std::make_shared<FunctionAcos>();
-    m_functionMap.insert(std::make_pair("acos",   functAcos));
-    m_functionMap.insert(std::make_pair("arccos", functAcos));
-    auto functAtan = std::make_shared<FunctionAtan>();
-    m_functionMap.insert(std::make_pair("atan",   functAtan));
-    m_functionMap.insert(std::make_pair("arctan", functAtan));
-    auto functLog10 = std::make_shared<FunctionLog10>();
-    m_functionMap.insert(std::make_pair("log10", functLog10));
-    m_functionMap.insert(std::make_pair("lg",    functLog10));
-
-    set_value(StringUtils::u8str(u8"\u03c0"), G_PI); // π or pi set some defaults
-    set_value("e", G_E);
-    set_value(StringUtils::u8str(u8"\u03d5"), (1.0 + sqrt(5.0)) / 2.0); // ϕ or phi
     // have to use proxy as it seems, to reflect property changes with functions
     //   custom setter,getter for property would be nice but the functions are not virtual...
     Glib::PropertyProxy<Glib::ustring> angle_proxy = property_angle_conv_id_.get_proxy();
     angle_proxy.signal_changed().connect(
         [this, angle_proxy] {
             Glib::ustring val = angle_proxy.get_value();
-            //std::cout << "angle setting val " << val << " actual " << m_angleConv->get_id() << std::endl;
-            if (val != m_angleConv->get_id()) {
-                m_angleConv = AngleConversion::get_conversion(val);
+            //std::cout << "angle setting val " << val << " actual " << get_angle_conv()->get_id() << std::endl;
+            if (val != get_angle_conv()->get_id()) {
+                set_angle_conv(AngleConversion::get_conversion(val));
             }
         });
     Glib::PropertyProxy<Glib::ustring> format_proxy = output_format_id_.get_proxy();
     format_proxy.signal_changed().connect(
         [this, format_proxy] {
             Glib::ustring val = format_proxy.get_value();
-            //std::cout << "format setting val " << val << " actual " << m_output_format->get_id() << std::endl;
-            if (val != m_output_format->get_id()) {
-                m_output_format = OutputForm::get_form(val);
+            //std::cout << "format setting val " << val << " actual " << get_output_format()->get_id() << std::endl;
+            if (val != get_output_format()->get_id()) {
+                set_output_format(OutputForm::get_form(val));
             }
         });
+    // the constants were set before the list existed
+    for (size_t slot = 0; slot < m_variables.size(); ++slot) {
+        if (m_variables.is_defined(slot)) {
+            variable_changed(slot);
+        }
+    }
+    flush();
+}
+
+EvalContext::~EvalContext()
+{
+    m_flushIdle.disconnect();
 }
 
 Glib::RefPtr<Gtk::ListStore>
@@ -95,29 +75,28 @@ EvalContext::get_list()
 bool
 EvalContext::find(Glib::ustring name, Gtk::TreeModel::Row* ret)
 {
-    typedef Gtk::TreeModel::Children type_children; //minimise code length.
-    type_children children = m_list->children();
-    for (type_children::iterator iter = children.begin(); iter != children.end(); ++iter) {
-        Gtk::TreeModel::Row row = *iter;
-        Glib::ustring varName = row[m_variable_columns.m_name];
-        if (varName == name) {
-            //std::cout << "Existing row for " << varName << std::endl;
-            *ret = row;
-            return true;
-        }
+    flush();
+    size_t slot;
+    if (m_variables.find(name, &slot)
+     && slot < m_rows.size()
+     && m_rows[slot]) {
+        *ret = *m_rows[slot];
+        return true;
     }
-    //std::cout << "No existing row for " << name << std::endl;
     return false;
 }
 
 void
 EvalContext::remove(Glib::ustring name)
 {
-    if (m_variables.erase(name)) { // remove old name
-        Gtk::TreeModel::Row row;
-        if (find(name, &row)) {
-            m_list->erase(row);
-        }
+    size_t slot;
+    if (m_variables.find(name, &slot)
+     && (m_variables.is_defined(slot)
+      || m_variables.is_list(slot))
+     && !m_variables.is_constant(slot)) { // remove old name
+        m_variables.remove(slot);
+        variable_changed(slot);
+        flush();
     }
     else {
         std::cout << "EvalContext::remove name " << name << " not found."  << std::endl;
@@ -128,76 +107,106 @@ void
 EvalContext::rename(Glib::ustring name, Glib::ustring newName)
 {
     double val = 0.0;
-    std::map<Glib::ustring, double>::iterator it = m_variables.find(name);
-    if (it != m_variables.end()) {
-        val = it->second;
-        m_variables.erase(it);
+    std::vector<double> values;
+    bool isList = false;
+    size_t slot;
+    if (is_constant(name)) {
+        std::cerr << "Constant " << name << " will not be renamed to " << newName << std::endl;
+        return;
+    }
+    // the value of a constant would be overwritten, or the row of a variable lost
+    size_t newSlot;
+    if (m_variables.find(newName, &newSlot)
+     && (m_variables.is_defined(newSlot)
+      || m_variables.is_list(newSlot))) {
+        std::cerr << "Name " << newName << " is used, " << name << " will not be renamed" << std::endl;
+        return;
+    }
+    flush();
+    Gtk::TreeIter row;
+    if (m_variables.find(name, &slot)
+     && (m_variables.is_defined(slot)
+      || m_variables.is_list(slot))) {
+        val = m_variables.get(slot);
+        isList = m_variables.is_list(slot);
+        auto list = m_variables.get_list(slot);
+        values.assign(list.begin(), list.end());
+        m_variables.remove(slot);
+        if (slot < m_rows.size()) {
+            std::swap(row, m_rows[slot]);      // keep the row at its place
+        }
     }
     else {
         std::cerr << "Coud not find name " << name << " in map, to rename  to " << newName << std::endl;
     }
-    m_variables.insert(std::pair<Glib::ustring, double>(newName, val)); // create new entry
-    Gtk::TreeModel::Row row;
-    if (find(name, &row)) {
-        row.set_value<Glib::ustring>(m_variable_columns.m_name, newName);
+    newSlot = m_variables.intern(newName);
+    variable_changed(newSlot);
+    if (row) {
+        row->set_value<Glib::ustring>(m_variable_columns.m_name, newName);
+        m_rows[newSlot] = row;
     }
+    if (isList) {
+        set_list(newName, std::move(values));
+    }
+    else {
+        m_variables.set(newSlot, val); // create new entry
+    }
+    flush();
 }
 
 void
 EvalContext::set_value(Glib::ustring name, double val)
 {
-    Gtk::TreeModel::Row row;
-    if (!find(name, &row)) {
-        Gtk::TreeIter iter = m_list->append();
-        row = *iter;
-        row.set_value(m_variable_columns.m_name, name);
-    }
-    row.set_value<double>(m_variable_columns.m_value, val);
-    std::map<Glib::ustring, double>::iterator it = m_variables.find(name);
-    if (it != m_variables.end())
-        m_variables.erase(it);
-    m_variables.insert(std::pair<Glib::ustring, double>(name, val));
+    set_variable(name, val);
 }
 
-bool
-EvalContext::get_variable(const Glib::ustring& name, double* val)
+// collect the changes, so a evaluation with many assignments
+//   will update each row just once
+void
+EvalContext::variable_changed(size_t slot)
 {
-    std::map<Glib::ustring, double>::iterator it = m_variables.find(name);
-    if (it != m_variables.end()) {
-        *val = it->second;
-        return true;
+    if (slot >= m_rows.size()) {
+        m_rows.resize(slot + 1);
+        m_isChanged.resize(slot + 1, 0);
+    }
+    if (!m_isChanged[slot]) {
+        m_isChanged[slot] = 1;
+        m_changed.push_back(slot);
+    }
+    if (!m_flushIdle.connected()) {
+        m_flushIdle = Glib::signal_idle().connect(
+            [this] {
+                flush();
+                return false;
+            });
     }
-    *val = 0.0;
-    return false;
 }
 
 void
-EvalContext::set_variable(const Glib::ustring& name, double val)
-{
-    set_value(name, val);
-}
-
-double
-EvalContext::toRadian(double in)
+EvalContext::flush()
 {
-    return m_angleConv->convert_to_radian(in);
-}
-
-double EvalContext::fromRadian(double in)
-{
-	return m_angleConv->convert_from_radian(in);
-}
-
-PtrAngleConversion
-EvalContext::get_angle_conv()
-{
-    return m_angleConv;
-}
-
-PtrOutputForm
-EvalContext::get_output_format()
-{
-    return m_output_format;
+    for (auto slot : m_changed) {
+        m_isChanged[slot] = 0;
+        auto& row = m_rows[slot];
+        bool isList = m_variables.is_list(slot);
+        if (m_variables.is_defined(slot)
+         || isList) {
+            if (!row) {
+                row = m_list->append();
+                row->set_value(m_variable_columns.m_name, m_variables.get_name(slot));
+            }
+            row->set_value<double>(m_variable_columns.m_value, isList
+                                                             ? static_cast<double>(m_variables.get_list(slot).size())
+                                                             : m_variables.get(slot));
+            row->set_value<bool>(m_variable_columns.m_isList, isList);
+        }
+        else if (row) {
+            m_list->erase(row);
+            row = Gtk::TreeIter();
+        }
+    }
+    m_changed.clear();
+    m_flushIdle.disconnect();
 }
 
 Glib::PropertyProxy<Glib::ustring>
@@ -236,37 +245,48 @@ EvalContext::load(Glib::RefPtr<Gio::Settings> settings)
     while (iter.next_value(entry)) {
         auto entryTup = entry.get();
         //            std::cout << "load name" << std::get<0>(entryTup) << "=" << std::get<1>(entryTup) << std::endl;
-        set_value(std::get<0>(entryTup), std::get<1>(entryTup));
+        if (!is_constant(std::get<0>(entryTup))) {     // saved by previous versions
+            set_value(std::get<0>(entryTup), std::get<1>(entryTup));
+        }
+    }
+    Glib::Variant<std::map<Glib::ustring, std::vector<double>>> lists;
+    settings->get_value(CONFIG_LISTS, lists);
+    for (auto& list : lists.get()) {
+        if (!is_constant(list.first)) {
+            set_list(list.first, std::move(list.second));
+        }
     }
 
     settings->bind(CONFIG_ANGLE_UNIT,
                    this, ANGLE_CONV_ID_PROPERTY, Gio::SettingsBindFlags::SETTINGS_BIND_GET);
     settings->bind(CONFIG_OUTPUT_FORMAT,
                    this, OUTPUT_FORMAT_ID_PROPERTY, Gio::SettingsBindFlags::SETTINGS_BIND_GET);
+    set_integration_limit(settings->get_uint(CONFIG_INTEGRATION_LIMIT));
 
+    // defined in the saved order, so a function is known to those that use it,
+    //   a definition that fails is dropped with the next save
+    Syntax syntax(get_output_format(), shared_from_this());
+    auto definitions = settings->get_string_array(CONFIG_FUNCTIONS);
+    for (auto& definition : definitions) {
+        try {
+            eval(syntax.parse(definition));
+        }
+        catch (const ParseError& err) {
+            std::cerr << "Restoring " << definition << " " << err.what() << std::endl;
+        }
+    }
 }
 
 void
 EvalContext::save(Glib::RefPtr<Gio::Settings> settings)
 {
-    auto values = Glib::Variant<std::map < Glib::ustring, double>>::create(m_variables);
+    auto values = Glib::Variant<std::map < Glib::ustring, double>>::create(get_variable_map());
     //std::cout << "save " << values.print(true) << std::endl;
     settings->set_value(VAR_CONFIG_GRP, values);
-}
-
-std::shared_ptr<Function>
-EvalContext::getFunction(const Glib::ustring& fun)
-{
-    auto& map = get_function_map();
-    auto iter = map.find(fun);
-    if (iter != map.end()) {
-        return iter->second;
+    settings->set_value(CONFIG_LISTS, Glib::Variant<std::map<Glib::ustring, std::vector<double>>>::create(get_list_map()));
+    std::vector<Glib::ustring> definitions;
+    for (auto& function : get_user_functions()) {
+        definitions.push_back(function->get_definition());
     }
-    return std::shared_ptr<Function>();
-}
-
-const EvalContext::FunctionMap &
-EvalContext::get_function_map()
-{
-    return m_functionMap;
+    settings->set_string_array(CONFIG_FUNCTIONS, definitions);
 }
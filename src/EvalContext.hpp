@@ -19,14 +19,11 @@
 #pragma once
 
 #include <gtkmm.h>
-#include <list>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
-#include "OutputForm.hpp"
-#include "AngleUnit.hpp"
-#include "Token.hpp"
-#include "Function.hpp"
-#include "BaseEval.hpp"
+#include "Evaluator.hpp"
 
 
 /*
@@ -36,38 +33,40 @@ class VariableColumns : public Gtk::TreeModel::ColumnRecord
 {
 public:
     Gtk::TreeModelColumn<Glib::ustring> m_name;
-    Gtk::TreeModelColumn<double> m_value;
+    Gtk::TreeModelColumn<double> m_value;     // the count of values for a list
+    Gtk::TreeModelColumn<bool> m_isList;
     VariableColumns()
     {
         add(m_name);
         add(m_value);
+        add(m_isList);
     }
 };
 
 /*
- * collects function needed mostly during evaluation of parser tree
- *   like output format, angle conversion and variable storage.
- *   Uses advanced setting types to store variable list.
+ * adapts the Evaluator for the gui,
+ *   keeps a list store to display the variables,
+ *   and properties for angle unit and output format.
+ *   Uses advanced setting types to store variable list,
+ *   the lists and the definitions of user functions.
  */
-class EvalContext : public Glib::Object, public BaseEval // inherit Glib:object as we use properties
+class EvalContext
+: public Glib::Object   // inherit Glib:object as we use properties
+, public Evaluator
+, public std::enable_shared_from_this<EvalContext>    // to parse the functions on load
 {
 public:
     EvalContext();
-    virtual ~EvalContext() = default;
+    virtual ~EvalContext();
 
     Glib::RefPtr<Gtk::ListStore> get_list();
     bool find(Glib::ustring name, Gtk::TreeModel::Row* ret);
     void remove(Glib::ustring name);
     void rename(Glib::ustring name, Glib::ustring newName);
     void set_value(Glib::ustring name, double val);
-    double toRadian(double in) override;
-    double fromRadian(double in) override;
-    std::shared_ptr<Function> getFunction(const Glib::ustring& fun) override;    // from ConversionContext
-
-    PtrAngleConversion get_angle_conv();
-    PtrOutputForm get_output_format();
-    bool get_variable(const Glib::ustring& name, double* val) override;
-    void set_variable(const Glib::ustring& name, double val) override;
+    // show the collected variable changes in the list,
+    //   done on idle or when a evaluation is complete
+    void flush();
 
     Glib::PropertyProxy<Glib::ustring> property_angle_conv_id();
     Glib::PropertyProxy_ReadOnly<Glib::ustring> property_angle_conv_id() const;
@@ -83,19 +82,23 @@ public:
     static constexpr auto VAR_CONFIG_GRP = "variables";
     static constexpr auto CONFIG_ANGLE_UNIT = "angle-unit";
     static constexpr auto CONFIG_OUTPUT_FORMAT = "output-format";
+    static constexpr auto CONFIG_INTEGRATION_LIMIT = "integration-limit";
+    static constexpr auto CONFIG_FUNCTIONS = "functions";
+    static constexpr auto CONFIG_LISTS = "lists";
+protected:
+    void variable_changed(size_t slot) override;
 private:
-    using FunctionMap = std::map<Glib::ustring, std::shared_ptr<Function>>;
-    const FunctionMap& get_function_map();
-    PtrAngleConversion m_angleConv;
-    PtrOutputForm m_output_format;
-
     Glib::Property<Glib::ustring> property_angle_conv_id_;
     Glib::Property<Glib::ustring> output_format_id_;
 
-    std::map<Glib::ustring, double> m_variables;
     // list a listStore to display variables
     Glib::RefPtr<Gtk::ListStore> m_list;
-    FunctionMap m_functionMap;
+    // the variables are kept in m_variables, the list just follows,
+    //   rows by slot, a invalid iter if there is no row
+    std::vector<Gtk::TreeIter> m_rows;
+    std::vector<size_t> m_changed;
+    std::vector<uint8_t> m_isChanged;   // by slot, to add each slot once
+    sigc::connection m_flushIdle;
 };
 
 using PtrEvalContext = std::shared_ptr<EvalContext>;
\ No newline at end of file
@@ -20,12 +20,16 @@
 #include <charconv>
 #include <optional>
 #include <system_error>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <StringUtils.hpp>
 #include <psc_i18n.hpp>
 #include <psc_format.hpp>
 
 #include "PlotDialog.hpp"
 #include "Syntax.hpp"
+#include "EvalFrame.hpp"
 
 PlotDialog::PlotDialog(BaseObjectType* cobject
                     , const Glib::RefPtr<Gtk::Builder>& builder
@@ -43,22 +47,46 @@ PlotDialog::PlotDialog(BaseObjectType* cobject
     builder->get_widget("apply", m_apply);
     builder->get_widget("min", m_min);
     builder->get_widget("max", m_max);
+    builder->get_widget("derivative", m_derivative);
     builder->get_widget("scroll", m_scroll);
     builder->get_widget_derived<psc::ui::PlotDrawing>("drawing", m_drawing);
 
     m_apply->signal_clicked().connect(sigc::mem_fun(*this, &PlotDialog::apply));
+    m_sampled.connect(sigc::mem_fun(*this, &PlotDialog::sampled));
+    m_notifier = std::make_shared<Notifier>();
+    m_notifier->dispatcher = &m_sampled;
+    // the cached tiles make it cheap to follow the range
+    m_min->signal_value_changed().connect(sigc::mem_fun(*this, &PlotDialog::resample));
+    m_max->signal_value_changed().connect(sigc::mem_fun(*this, &PlotDialog::resample));
+    m_derivative->signal_toggled().connect(sigc::mem_fun(*this, &PlotDialog::apply));
+    m_drawing->signal_size_allocate().connect(
+        [this] (Gtk::Allocation& allocation) {
+            if (!m_expressions.empty()
+             && get_budget() != m_sampledBudget) {
+                resample();
+            }
+        });
 }
 
+PlotDialog::~PlotDialog()
+{
+    cancel_sampling();  // the tasks keep the expressions, but need not finish
+    std::lock_guard<std::mutex> lock(m_notifier->mutex);
+    m_notifier->dispatcher = nullptr;
+}
+
+// the expressions that keep their text are reused
+//   with the samples they have
 void
 PlotDialog::apply()
 {
-    auto& xAxis = m_drawing->getXAxis();
-    xAxis.setMinMax(m_min->get_value(), m_max->get_value());
-    std::vector<std::shared_ptr<psc::ui::PlotView>> views;
+    cancel_sampling();
+    auto previous = std::move(m_expressions);
+    m_expressions.clear();
     try {
         auto fun1 = m_fun1->get_text();
         try {
-            addExpression(fun1, m_col1->get_rgba(), views);
+            addExpression(fun1, m_col1->get_rgba(), previous);
         }
         catch (const std::exception& exc) {
             auto msg = exc.what();
@@ -68,7 +96,7 @@ PlotDialog::apply()
         }
         auto fun2 = m_fun2->get_text();
         try {
-            addExpression(fun2, m_col2->get_rgba(), views);
+            addExpression(fun2, m_col2->get_rgba(), previous);
         }
         catch (const std::exception& exc) {
             auto msg = exc.what();
@@ -78,7 +106,7 @@ PlotDialog::apply()
         }
         auto fun3 = m_fun3->get_text();
         try {
-            addExpression(fun3, m_col3->get_rgba(), views);
+            addExpression(fun3, m_col3->get_rgba(), previous);
         }
         catch (const std::exception& exc) {
             auto msg = exc.what();
@@ -86,8 +114,7 @@ PlotDialog::apply()
                         _("Parse error {} for {}" ),
                           psc::fmt::make_format_args(msg, fun3)));
         }
-        m_drawing->setPlot(views);
-        m_drawing->refresh();
+        resample();
     }
     catch (const std::exception& exc) {
             auto msg = exc.what();
@@ -95,9 +122,84 @@ PlotDialog::apply()
                         _("Error evaluating {}" ),
                           psc::fmt::make_format_args(msg)));
     }
-    m_evalContext->remove("x");
 }
 
+// all curves and their tiles are sampled in parallel,
+//   the ui stays responsive until sampled() draws them
+void
+PlotDialog::resample()
+{
+    cancel_sampling();
+    auto& xAxis = m_drawing->getXAxis();
+    xAxis.setMinMax(m_min->get_value(), m_max->get_value());
+    m_sampledBudget = get_budget();
+    if (m_expressions.empty()) {
+        m_drawing->setPlot(std::vector<std::shared_ptr<psc::ui::PlotView>>());
+        m_drawing->refresh();
+        return;
+    }
+    m_sampling = std::make_shared<Sampling>();
+    m_sampling->expressions = m_expressions;
+    auto ready = [notifier = m_notifier, sampling = m_sampling] {
+        std::lock_guard<std::mutex> lock(notifier->mutex);
+        if (notifier->dispatcher) {
+            notifier->dispatcher->emit();
+        }
+    };
+    for (auto& expr : m_expressions) {
+        m_sampling->samples.push_back(expr->sample(m_min->get_value(), m_max->get_value(), m_sampledBudget, ready));
+    }
+}
+
+// rounded to a power of 2, so just a larger change
+//   of the width requires new samples
+size_t
+PlotDialog::get_budget()
+{
+    auto width = static_cast<size_t>(std::max(m_drawing->get_allocated_width(), 0));
+    return std::bit_ceil(std::max(width * BUDGET_PER_PIXEL, BUDGET_MIN));
+}
+
+// a result not yet drawn is outdated
+void
+PlotDialog::cancel_sampling()
+{
+    m_sampling.reset();
+    for (auto& expr : m_expressions) {
+        expr->cancel();
+    }
+}
+
+// notified by each curve, also of a outdated sampling
+void
+PlotDialog::sampled()
+{
+    if (!m_sampling) {
+        return;
+    }
+    for (auto& samples : m_sampling->samples) {
+        if (samples.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+    }
+    auto sampling = std::move(m_sampling);
+    std::vector<std::shared_ptr<psc::ui::PlotView>> views;
+    for (size_t i = 0; i < sampling->samples.size(); ++i) {
+        auto& expr = sampling->expressions[i];
+        try {
+            expr->set_samples(sampling->samples[i].get());
+            views.push_back(expr);
+        }
+        catch (const std::exception& exc) {
+            auto msg = exc.what();
+            show_error(psc::fmt::vformat(
+                        _("Error evaluating {}" ),
+                          psc::fmt::make_format_args(msg)));
+        }
+    }
+    m_drawing->setPlot(views);
+    m_drawing->refresh();
+}
 
 void
 PlotDialog::show_error(const Glib::ustring& msg, Gtk::MessageType type)
@@ -110,40 +212,64 @@ PlotDialog::show_error(const Glib::ustring& msg, Gtk::MessageType type)
 void
 PlotDialog::addExpression(const Glib::ustring& fun
                         , Gdk::RGBA color
-                        , std::vector<std::shared_ptr<psc::ui::PlotView>>& views)
+                        , const std::vector<std::shared_ptr<PlotExpression>>& previous)
 {
     auto fn{fun};
     StringUtils::trim(fn);
     if (!fn.empty()) {
-        auto expr = std::make_shared<PlotExpression>(fn, m_evalContext);
+        auto same = std::find_if(previous.begin(), previous.end(),
+            [this, &fn] (const std::shared_ptr<PlotExpression>& expr) {
+                return expr->get_text() == fn
+                    && expr->is_derivative() == m_derivative->get_active()
+                    && expr->get_compile_version() == m_evalContext->get_compile_version();
+            });
+        auto expr = same != previous.end()
+                    ? *same
+                    : std::make_shared<PlotExpression>(fn, m_evalContext, m_derivative->get_active());
         expr->setPlotColor(color);
-        views.push_back(expr);
+        m_expressions.push_back(expr);
     }
 }
 
 
 
-PlotExpression::PlotExpression(Glib::ustring& fun, const std::shared_ptr<EvalContext>& evalContext)
+PlotExpression::PlotExpression(Glib::ustring& fun, const std::shared_ptr<EvalContext>& evalContext, bool derivative)
 : m_evalContext{evalContext}
+, m_text{fun}
+, m_derivative{derivative}
+, m_compileVersion{evalContext->get_compile_version()}
 {
-    m_evalContext->set_variable("x", 0.0);    // ensure variable is found
     Syntax syntax(m_evalContext->get_output_format(), m_evalContext);
-    m_list = syntax.parse(fun);
+    auto ast = syntax.parse(fun);
 #   ifdef DEBUG
     std::cout << "PlotExpression::PlotExpression" << std::endl;
-    for (auto tok : m_list1) {
-        std::cout << tok->show() << std::endl;
-    }
+    std::cout << ast.show() << std::endl;
 #   endif
+    // parse and resolve once, as we evaluate this for every point,
+    //   x is bound as parameter so the variables stay untouched
+    m_program = m_evalContext->compile(ast, {PARAM_X});
+    m_sampler = std::make_unique<PlotSampler>(*m_evalContext, m_program, m_derivative);
 }
 
 
 
+// points within the sampled range are interpolated,
+//   outside e.g. after scrolling they are evaluated
 double
 PlotExpression::calculate(double x)
 {
-    m_evalContext->set_variable("x", x);
-    double y = m_evalContext->eval(m_list);
+    if (m_samples.contains(x)) {
+        return m_samples.interpolate(x);
+    }
+    double y;
+    if (m_derivative) {
+        EvalFrame frame(*m_evalContext);
+        Dual arg(x, 1.0);
+        y = frame.eval_dual(*m_program, std::span<const Dual>(&arg, 1)).der;
+    }
+    else {
+        y = m_evalContext->eval(m_program, std::span<const double>(&x, 1));
+    }
 #   ifdef DEBUG
     std::cout << "PlotExpression::calculate"
               << " x " << x
@@ -151,3 +277,52 @@ PlotExpression::calculate(double x)
 #   endif
     return y;
 }
+
+// evaluate a whole range of points at once
+void
+PlotExpression::calculate(std::span<const double> x, std::span<double> y)
+{
+    if (m_derivative) {
+        for (size_t i = 0; i < x.size(); ++i) {
+            y[i] = calculate(x[i]);
+        }
+        return;
+    }
+    m_evalContext->eval_batch(m_program, x, y);
+}
+
+std::future<Samples>
+PlotExpression::sample(double min, double max, size_t budget, std::function<void()> ready)
+{
+    return m_sampler->sample_tiles(min, max, budget, std::move(ready));
+}
+
+void
+PlotExpression::cancel()
+{
+    m_sampler->cancel();
+}
+
+const Glib::ustring&
+PlotExpression::get_text() const
+{
+    return m_text;
+}
+
+bool
+PlotExpression::is_derivative() const
+{
+    return m_derivative;
+}
+
+uint64_t
+PlotExpression::get_compile_version() const
+{
+    return m_compileVersion;
+}
+
+void
+PlotExpression::set_samples(Samples&& samples)
+{
+    m_samples = std::move(samples);
+}
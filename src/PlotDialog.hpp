@@ -21,10 +21,15 @@
 #include <gtkmm.h>
 #include <Plot.hpp>
 #include <map>
+#include <future>
+#include <mutex>
 
 #include "EvalContext.hpp"
 #include "BaseEval.hpp"
 #include "NumberFormat.hpp"
+#include "PlotSampler.hpp"
+
+class PlotExpression;
 
 class PlotDialog
 : public Gtk::Dialog
@@ -34,17 +39,26 @@ public:
             , const Glib::RefPtr<Gtk::Builder>& builder
             , const std::shared_ptr<EvalContext>& evalContext);
     explicit PlotDialog(const PlotDialog& orig) = delete;
-    virtual ~PlotDialog() = default;
+    virtual ~PlotDialog();
 
     void apply();
+    // evaluations per curve relative to the drawing width,
+    //   the adaptive sampling puts them where the curve bends
+    static constexpr size_t BUDGET_PER_PIXEL{1};
+    static constexpr size_t BUDGET_MIN{512};
     bool get_variable(const Glib::ustring& name, double* val);
     void set_variable(const Glib::ustring& name, double val);
     NumberFormat* getFormat();
 
 protected:
+    struct Sampling;
     void addExpression(const Glib::ustring& fun
             , Gdk::RGBA color
-            , std::vector<std::shared_ptr<psc::ui::PlotView>>& views);
+            , const std::vector<std::shared_ptr<PlotExpression>>& previous);
+    void resample();
+    size_t get_budget();
+    void cancel_sampling();
+    void sampled();
     void show_error(const Glib::ustring& msg
             , Gtk::MessageType type = Gtk::MessageType::MESSAGE_ERROR);
 
@@ -61,7 +75,27 @@ private:
     Gtk::Button* m_apply;
     Gtk::SpinButton* m_min;
     Gtk::SpinButton* m_max;
+    Gtk::CheckButton* m_derivative;
     psc::ui::PlotDrawing* m_drawing;
+    // the curves are sampled in the background, and drawn once all are done,
+    //   the tasks keep the sampling they belong to, with the expressions
+    //   it uses, so a outdated one is just left to end
+    struct Sampling
+    {
+        std::vector<std::shared_ptr<PlotExpression>> expressions;
+        std::vector<std::future<Samples>> samples;
+    };
+    // the tasks notify as long as the dialog is there
+    struct Notifier
+    {
+        std::mutex mutex;
+        Glib::Dispatcher* dispatcher;
+    };
+    std::vector<std::shared_ptr<PlotExpression>> m_expressions;
+    size_t m_sampledBudget{};
+    std::shared_ptr<Sampling> m_sampling;
+    Glib::Dispatcher m_sampled;
+    std::shared_ptr<Notifier> m_notifier;
 };
 
 
@@ -70,13 +104,31 @@ class PlotExpression
 : public psc::ui::PlotFunction
 {
 public:
-    PlotExpression(Glib::ustring& fun, const std::shared_ptr<EvalContext>& evalContext);
+    // derivative plots f'(x)
+    PlotExpression(Glib::ustring& fun, const std::shared_ptr<EvalContext>& evalContext, bool derivative = false);
     ~ PlotExpression() = default;
 
     double calculate(double x) override;
+    void calculate(std::span<const double> x, std::span<double> y);
+    // ready is called from the sampling task once the result is ready
+    std::future<Samples> sample(double min, double max, size_t budget, std::function<void()> ready);
+    // the running samplings end early
+    void cancel();
+    void set_samples(Samples&& samples);
+    const Glib::ustring& get_text() const;
+    bool is_derivative() const;
+    // the version of the context the program was compiled with,
+    //   e.g. a redefined function requires to compile again
+    uint64_t get_compile_version() const;
 
+    static constexpr auto PARAM_X{"x"};
 private:
     std::shared_ptr<EvalContext> m_evalContext;
-    std::list<std::shared_ptr<Token>> m_list;
+    Glib::ustring m_text;
+    bool m_derivative;
+    uint64_t m_compileVersion;
+    PtrProgram m_program;
+    std::unique_ptr<PlotSampler> m_sampler;
+    Samples m_samples;
 };
 
@@ -0,0 +1,96 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "BatchEval.hpp"
+
+BatchEval::BatchEval()
+: m_evaluator{std::make_shared<Evaluator>()}
+, m_syntax{std::make_unique<Syntax>(m_evaluator->get_output_format(), m_evaluator)}
+{
+}
+
+bool
+BatchEval::set_output_format(const Glib::ustring& id)
+{
+    for (auto& form : OutputForm::get_forms()) {
+        if (form->get_id() == id) {
+            m_evaluator->set_output_format(form);
+            // the syntax parses numbers with the format
+            m_syntax = std::make_unique<Syntax>(form, m_evaluator);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+BatchEval::set_angle_conv(const Glib::ustring& id)
+{
+    for (auto& conv : AngleConversion::get_conversions()) {
+        if (conv->get_id() == id) {
+            m_evaluator->set_angle_conv(conv);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<Evaluator>
+BatchEval::get_evaluator()
+{
+    return m_evaluator;
+}
+
+size_t
+BatchEval::run(std::istream& in, std::ostream& out, std::ostream& err)
+{
+    size_t failed = 0;
+    size_t lineNo = 0;
+    std::string line;   // reused, so long inputs will not allocate for each line
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (!eval_line(line, out, err, lineNo)) {
+            ++failed;
+        }
+    }
+    out.flush();
+    return failed;
+}
+
+bool
+BatchEval::eval_line(std::string_view line, std::ostream& out, std::ostream& err, size_t lineNo)
+{
+    auto start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) {
+        out << '\n';
+        return true;
+    }
+    auto end = line.find_last_not_of(" \t\r");
+    try {
+        double val = m_evaluator->eval(m_syntax->parse(line.substr(start, end - start + 1)));
+        out << m_evaluator->get_output_format()->format(val) << '\n';
+    }
+    catch (const ParseError& error) {
+        out << '\n';
+        err << "Line " << lineNo << ": " << error.what() << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include "Evaluator.hpp"
+#include "Syntax.hpp"
+
+/*
+ * evaluate a stream of expressions line by line,
+ *   each input line gives one output line,
+ *   that is empty for empty lines or errors (reported on the error stream).
+ *   Variables assigned are kept for the following lines.
+ */
+class BatchEval
+{
+public:
+    BatchEval();
+    explicit BatchEval(const BatchEval& orig) = delete;
+    virtual ~BatchEval() = default;
+
+    // returns the number of lines that failed
+    size_t run(std::istream& in, std::ostream& out, std::ostream& err);
+    // format is a id of OutputForm, returns false if not known
+    bool set_output_format(const Glib::ustring& id);
+    // angle is a id of AngleConversion, returns false if not known
+    bool set_angle_conv(const Glib::ustring& id);
+    std::shared_ptr<Evaluator> get_evaluator();
+
+private:
+    bool eval_line(std::string_view line, std::ostream& out, std::ostream& err, size_t lineNo);
+
+    std::shared_ptr<Evaluator> m_evaluator;
+    std::unique_ptr<Syntax> m_syntax;
+};
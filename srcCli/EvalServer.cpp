@@ -0,0 +1,183 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "EvalServer.hpp"
+
+static volatile std::sig_atomic_t running{1};
+
+EvalServer::EvalServer(const std::string& path)
+: m_path{path}
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_listen < 0) {
+        throw std::runtime_error(std::string("Cannot create socket ") + std::strerror(errno));
+    }
+    unlink(path.c_str());      // left from a previous run
+    if (bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+     || listen(m_listen, SOMAXCONN) < 0) {
+        auto error = std::string("Cannot listen on ") + path + " " + std::strerror(errno);
+        close(m_listen);
+        throw std::runtime_error(error);
+    }
+}
+
+EvalServer::~EvalServer()
+{
+    for (auto& entry : m_connections) {
+        close(entry.first);
+    }
+    if (m_listen >= 0) {
+        close(m_listen);
+        unlink(m_path.c_str());
+    }
+}
+
+void
+EvalServer::stop()
+{
+    running = 0;
+}
+
+void
+EvalServer::run()
+{
+    std::vector<pollfd> fds;
+    while (running) {
+        fds.clear();
+        fds.push_back(pollfd{m_listen, POLLIN, 0});
+        for (auto& entry : m_connections) {
+            short events = entry.second->closing
+                        || entry.second->out.size() >= OUT_LIMIT ? 0 : POLLIN;
+            if (!entry.second->out.empty()) {
+                events |= POLLOUT;
+            }
+            fds.push_back(pollfd{entry.first, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Poll failed ") + std::strerror(errno));
+        }
+        if (fds[0].revents & POLLIN) {
+            accept_connection();
+        }
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            int fd = fds[i].fd;
+            auto& connection = *m_connections[fd];
+            bool keep = (fds[i].revents & (POLLERR | POLLNVAL)) == 0;
+            if (keep
+             && !connection.closing
+             && connection.out.size() < OUT_LIMIT
+             && (fds[i].revents & (POLLIN | POLLHUP))) {
+                keep = read_connection(fd, connection);
+            }
+            if (keep
+             && !connection.out.empty()) {
+                keep = write_connection(fd, connection);
+            }
+            if (!keep
+             || (connection.closing && connection.out.empty())) {
+                close(fd);
+                m_connections.erase(fd);
+            }
+        }
+    }
+}
+
+void
+EvalServer::accept_connection()
+{
+    while (true) {
+        int fd = accept4(m_listen, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno != EAGAIN
+             && errno != EWOULDBLOCK
+             && errno != EINTR) {
+                std::cerr << "Accept failed " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        m_connections.emplace(fd, std::make_unique<Connection>(&m_stats));
+    }
+}
+
+// read what is available, all complete requests get answered at once
+bool
+EvalServer::read_connection(int fd, Connection& connection)
+{
+    std::array<char, READ_BUFFER> buffer;
+    while (true) {
+        auto len = read(fd, buffer.data(), buffer.size());
+        if (len > 0) {
+            if (!connection.session.receive(std::string_view(buffer.data(), static_cast<size_t>(len)), connection.out)) {
+                return false;   // protocol error
+            }
+            if (static_cast<size_t>(len) < buffer.size()
+             || connection.out.size() >= OUT_LIMIT) {
+                return true;    // the rest when the client has read
+            }
+        }
+        else if (len == 0) {
+            connection.closing = true;  // answer what we got
+            return true;
+        }
+        else {
+            return errno == EAGAIN
+                || errno == EWOULDBLOCK
+                || errno == EINTR;
+        }
+    }
+}
+
+bool
+EvalServer::write_connection(int fd, Connection& connection)
+{
+    while (!connection.out.empty()) {
+        auto len = send(fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+        if (len < 0) {
+            return errno == EAGAIN
+                || errno == EWOULDBLOCK
+                || errno == EINTR;
+        }
+        connection.out.erase(0, static_cast<size_t>(len));
+    }
+    return true;
+}
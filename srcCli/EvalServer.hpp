@@ -0,0 +1,66 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "EvalSession.hpp"
+
+/*
+ * serve EvalSessions on a unix domain socket,
+ *   all connections are handled by one thread with poll,
+ *   start more daemons on different sockets to use more cores.
+ */
+class EvalServer
+{
+public:
+    explicit EvalServer(const std::string& path);
+    explicit EvalServer(const EvalServer& orig) = delete;
+    virtual ~EvalServer();
+
+    // returns when stop was called e.g. from a signal handler
+    void run();
+    static void stop();
+private:
+    struct Connection
+    {
+        explicit Connection(EvalStats* stats)
+        : session{stats}
+        {
+        }
+        EvalSession session;
+        std::string out;        // responses not yet written
+        bool closing{};         // peer will not send more, close when out is written
+    };
+
+    void accept_connection();
+    bool read_connection(int fd, Connection& connection);
+    bool write_connection(int fd, Connection& connection);
+
+    std::string m_path;
+    int m_listen{-1};
+    std::map<int, std::unique_ptr<Connection>> m_connections;
+    EvalStats m_stats;
+    static constexpr size_t READ_BUFFER{1u << 16};
+    // above this many bytes of responses a connection is not read,
+    //   until the client took them, so it can't make us grow without limit
+    static constexpr size_t OUT_LIMIT{1u << 20};
+};
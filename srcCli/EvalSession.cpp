@@ -0,0 +1,174 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <sstream>
+
+#include "EvalSession.hpp"
+
+void
+EvalStats::add(uint64_t ns, bool error, bool cacheHit)
+{
+    ++requests;
+    if (error) {
+        ++errors;
+    }
+    if (cacheHit) {
+        ++cacheHits;
+    }
+    totalNs += ns;
+    maxNs = std::max(maxNs, ns);
+    ++histogram[static_cast<size_t>(std::bit_width(ns))];
+}
+
+uint64_t
+EvalStats::percentile(double fraction) const
+{
+    auto limit = static_cast<uint64_t>(fraction * static_cast<double>(requests));
+    uint64_t count = 0;
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        count += histogram[bucket];
+        if (count > limit) {
+            return bucket > 0 ? (uint64_t{1} << (bucket - 1)) * 2 - 1 : 0;
+        }
+    }
+    return maxNs;
+}
+
+std::string
+EvalStats::show() const
+{
+    std::ostringstream out;
+    out << "requests " << requests
+        << " errors " << errors
+        << " cache_hits " << cacheHits
+        << " mean_ns " << (requests > 0 ? totalNs / requests : 0)
+        << " p50_ns " << percentile(0.5)
+        << " p99_ns " << percentile(0.99)
+        << " max_ns " << maxNs;
+    return out.str();
+}
+
+EvalSession::EvalSession(EvalStats* stats)
+: m_evaluator{std::make_shared<Evaluator>()}
+, m_syntax{m_evaluator->get_output_format(), m_evaluator}
+, m_stats{stats}
+{
+}
+
+void
+EvalSession::frame(char type, std::string_view payload, std::string& out)
+{
+    auto length = static_cast<uint32_t>(payload.size() + 1);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((length >> shift) & 0xffu));
+    }
+    out.push_back(type);
+    out.append(payload);
+}
+
+bool
+EvalSession::receive(std::string_view data, std::string& out)
+{
+    m_pending.append(data);
+    std::string_view pending{m_pending};
+    size_t pos = 0;
+    while (pending.size() - pos >= HEADER_SIZE) {
+        uint32_t length = 0;
+        for (size_t i = 0; i < HEADER_SIZE; ++i) {
+            length = (length << 8) | static_cast<unsigned char>(pending[pos + i]);
+        }
+        if (length == 0
+         || length > FRAME_LIMIT) {
+            return false;
+        }
+        if (pending.size() - pos - HEADER_SIZE < length) {
+            break;      // wait for the rest
+        }
+        auto request = pending.substr(pos + HEADER_SIZE, length);
+        handle(request[0], request.substr(1), out);
+        pos += HEADER_SIZE + length;
+    }
+    m_pending.erase(0, pos);
+    return true;
+}
+
+void
+EvalSession::handle(char type, std::string_view payload, std::string& out)
+{
+    switch (type) {
+    case 'E':
+        evaluate(payload, out);
+        break;
+    case 'S':
+        frame('S', m_stats->show(), out);
+        break;
+    default:
+        frame('E', "Unknown request", out);
+        break;
+    }
+}
+
+void
+EvalSession::evaluate(std::string_view expr, std::string& out)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool error = false;
+    bool cacheHit = false;
+    try {
+        std::string key{expr};
+        if (m_compileVersion != m_evaluator->get_compile_version()) {
+            m_cache.clear();    // e.g. a call may be inlined with a previous definition
+            m_compileVersion = m_evaluator->get_compile_version();
+        }
+        auto entry = m_cache.find(key);
+        PtrProgram program;
+        if (entry != m_cache.end()) {
+            program = entry->second;
+            cacheHit = true;
+        }
+        else {
+            program = m_evaluator->compile(m_syntax.parse(expr));
+            if (m_cache.size() >= CACHE_LIMIT) {
+                m_cache.clear();    // simple, as repeated expressions will be back soon
+            }
+            m_cache.emplace(std::move(key), program);
+        }
+        double val = m_evaluator->eval(program);
+        std::array<char, 32> buf;
+        auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), val);
+        frame('R', std::string_view(buf.data(), static_cast<size_t>(ptr - buf.data())), out);
+    }
+    catch (const ParseError& err) {
+        error = true;
+        frame('E', err.what(), out);
+    }
+    // e.g. a malformed payload, just this request fails
+    catch (const std::exception& err) {
+        error = true;
+        frame('E', err.what(), out);
+    }
+    catch (const Glib::Exception& err) {  // as a conversion error, not a std::exception
+        error = true;
+        frame('E', err.what().raw(), out);
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    m_stats->add(static_cast<uint64_t>(ns), error, cacheHit);
+}
@@ -0,0 +1,92 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Evaluator.hpp"
+#include "Syntax.hpp"
+#include "Program.hpp"
+
+/*
+ * counts and latency of the requests,
+ *   latencies are kept as histogram by powers of two nanoseconds
+ *   so percentiles are approximated by the bucket bound.
+ */
+struct EvalStats
+{
+    uint64_t requests{};
+    uint64_t errors{};
+    uint64_t cacheHits{};
+    uint64_t totalNs{};
+    uint64_t maxNs{};
+    std::array<uint64_t, 64> histogram{};
+
+    void add(uint64_t ns, bool error, bool cacheHit);
+    // upper bound of the latency for the fraction of requests in ns
+    uint64_t percentile(double fraction) const;
+    std::string show() const;
+};
+
+/*
+ * the protocol for a connection of the evaluation daemon,
+ *   kept apart from the socket handling.
+ *   Each frame is a 4 byte big endian length, followed by
+ *   a type byte and the payload (the length includes the type).
+ *   Requests:  'E' expression  evaluate, assignments are kept for the connection
+ *              'S'             statistics
+ *   Responses: 'R' value       shortest text that reads back to the same double
+ *              'E' message     the request failed
+ *              'S' text        statistics
+ *   Requests may be pipelined, responses are send in order.
+ */
+class EvalSession
+{
+public:
+    explicit EvalSession(EvalStats* stats);
+    explicit EvalSession(const EvalSession& orig) = delete;
+    virtual ~EvalSession() = default;
+
+    // consume received bytes, complete requests are answered by appending to out,
+    //   returns false if the peer violated the protocol
+    bool receive(std::string_view data, std::string& out);
+
+    static void frame(char type, std::string_view payload, std::string& out);
+
+    // compiled programs kept for each connection
+    static constexpr size_t CACHE_LIMIT{4096};
+    static constexpr uint32_t FRAME_LIMIT{1u << 20};
+    static constexpr size_t HEADER_SIZE{4};
+private:
+    void handle(char type, std::string_view payload, std::string& out);
+    void evaluate(std::string_view expr, std::string& out);
+
+    std::shared_ptr<Evaluator> m_evaluator;
+    Syntax m_syntax;
+    // programs refer to the variable slots of our evaluator, so the cache is not shared
+    std::unordered_map<std::string, PtrProgram> m_cache;
+    uint64_t m_compileVersion{};
+    std::string m_pending;      // incomplete frame
+    EvalStats* m_stats;
+};
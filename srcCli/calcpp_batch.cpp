@@ -0,0 +1,112 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <clocale>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <string_view>
+#include <vector>
+#include <psc_i18n.hpp>
+
+#include "BatchEval.hpp"
+#include "calcpp_config.h"
+
+// evaluate expressions from a file or stdin without the gui
+//   calcpp-batch [-f format] [-a angle] [file]
+
+static void
+usage(std::ostream& out)
+{
+    out << "Usage: calcpp-batch [-f format] [-a angle] [file]" << std::endl
+        << "  evaluates the expressions of each line from file or stdin," << std::endl
+        << "  and writes one result line for each." << std::endl
+        << "  -f format: ";
+    for (auto& form : OutputForm::get_forms()) {
+        out << form->get_id() << " ";
+    }
+    out << std::endl << "  -a angle: ";
+    for (auto& conv : AngleConversion::get_conversions()) {
+        out << conv->get_id() << " ";
+    }
+    out << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    char* loc = std::setlocale(LC_ALL, "");
+    if (loc != nullptr) {
+        std::locale::global(std::locale(loc));
+    }
+    bindtextdomain(PACKAGE, PACKAGE_LOCALE_DIR);
+    textdomain(PACKAGE);
+    std::ios::sync_with_stdio(false);   // we only use the c++ streams
+    std::cin.tie(nullptr);
+
+    BatchEval batchEval;
+    const char* fileName = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};
+        if ((arg == "-f" || arg == "-a")
+          && i + 1 < argc) {
+            Glib::ustring id{argv[++i]};
+            bool known = arg == "-f"
+                        ? batchEval.set_output_format(id)
+                        : batchEval.set_angle_conv(id);
+            if (!known) {
+                std::cerr << "Unknown " << arg << " " << id << std::endl;
+                usage(std::cerr);
+                return 2;
+            }
+        }
+        else if (arg == "-h" || arg == "--help") {
+            usage(std::cout);
+            return 0;
+        }
+        else if (fileName == nullptr
+              && (arg == "-" || !arg.starts_with("-"))) {
+            fileName = argv[i];
+        }
+        else {
+            usage(std::cerr);
+            return 2;
+        }
+    }
+    // read in larger blocks, as we process line by line,
+    //   cout is buffered already as it is not synced with stdio,
+    //   and is flushed after main returned
+    constexpr size_t BUFFER_SIZE{1u << 16};
+    size_t failed;
+    if (fileName == nullptr
+     || std::strcmp(fileName, "-") == 0) {
+        failed = batchEval.run(std::cin, std::cout, std::cerr);
+    }
+    else {
+        std::vector<char> inBuffer(BUFFER_SIZE);    // outlives in
+        std::ifstream in;
+        in.rdbuf()->pubsetbuf(inBuffer.data(), static_cast<std::streamsize>(inBuffer.size()));
+        in.open(fileName);
+        if (!in) {
+            std::cerr << "Cannot open " << fileName << std::endl;
+            return 2;
+        }
+        failed = batchEval.run(in, std::cout, std::cerr);
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+
+#include "EvalServer.hpp"
+
+// evaluation service on a unix domain socket, see EvalSession for the protocol
+//   calcpp-daemon socket-path
+
+static void
+on_signal(int)
+{
+    EvalServer::stop();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: calcpp-daemon socket-path" << std::endl;
+        return 2;
+    }
+    // no setlocale, so numbers always use . as decimal point
+    struct sigaction action{};
+    action.sa_handler = on_signal;      // no SA_RESTART, so poll returns
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    try {
+        EvalServer server(argv[1]);
+        server.run();
+    }
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
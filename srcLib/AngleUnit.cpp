@@ -82,6 +82,12 @@ RadianConversion::convert_from_radian(double in)
     return in;
 }
 
+double
+RadianConversion::get_right_angle()
+{
+    return G_PI / 2.0;
+}
+
 DegreeConversion::DegreeConversion()
 : AngleConversion("deg", _("Degree (°)"))
 {
@@ -99,6 +105,12 @@ DegreeConversion::convert_from_radian(double in)
     return in * 180.0 / G_PI;
 }
 
+double
+DegreeConversion::get_right_angle()
+{
+    return 90.0;
+}
+
 GonConversion::GonConversion()
 : AngleConversion("gon", _("Gon"))
 {
@@ -115,3 +127,9 @@ GonConversion::convert_from_radian(double in)
 {
     return in * 200.0 / G_PI;
 }
+
+double
+GonConversion::get_right_angle()
+{
+    return 100.0;
+}
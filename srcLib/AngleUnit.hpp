@@ -40,6 +40,8 @@ public:
 
     virtual double convert_to_radian(double in) = 0;
     virtual double convert_from_radian(double in) = 0;
+    // size of a right angle in this unit
+    virtual double get_right_angle() = 0;
     Glib::ustring get_id();
     Glib::ustring get_name();
 
@@ -62,6 +64,7 @@ public:
 
     double convert_to_radian(double in) override;
     double convert_from_radian(double in) override;
+    double get_right_angle() override;
 };
 
 class DegreeConversion
@@ -72,6 +75,7 @@ public:
 
     double convert_to_radian(double in) override;
     double convert_from_radian(double in) override;
+    double get_right_angle() override;
 };
 
 class GonConversion
@@ -82,4 +86,5 @@ public:
 
     double convert_to_radian(double in) override;
     double convert_from_radian(double in) override;
+    double get_right_angle() override;
 };
@@ -0,0 +1,132 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Ast.hpp"
+
+Ast::Ast(std::string_view text)
+: m_text{text}
+{
+    m_nodes.reserve(text.size() / 2 + 1);
+}
+
+uint32_t
+Ast::add(const Token& token)
+{
+    m_nodes.emplace_back(AstNode{token});
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+uint32_t
+Ast::add(const Token& token, std::span<const uint32_t> operands)
+{
+    AstNode node{token};
+    node.count = static_cast<uint32_t>(operands.size());
+    if (!operands.empty()) {
+        node.first = operands[0];
+        for (size_t i = 1; i < operands.size(); ++i) {
+            m_nodes[operands[i - 1]].next = operands[i];
+        }
+    }
+    m_nodes.emplace_back(node);
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+const AstNode&
+Ast::operator[](uint32_t node) const
+{
+    return m_nodes[node];
+}
+
+size_t
+Ast::size() const
+{
+    return m_nodes.size();
+}
+
+uint32_t
+Ast::get_root() const
+{
+    return m_root;
+}
+
+void
+Ast::set_root(uint32_t root)
+{
+    m_root = root;
+}
+
+std::string_view
+Ast::get_text() const
+{
+    return m_text;
+}
+
+Glib::ustring
+Ast::get_id(const Token& token) const
+{
+    return Glib::ustring{std::string(get_text().substr(token.offset, token.length))};
+}
+
+Glib::ustring
+Ast::show() const
+{
+    if (m_root == AstNode::NONE) {
+        return "";
+    }
+    return show(m_root);
+}
+
+Glib::ustring
+Ast::show(uint32_t node) const
+{
+    const AstNode& astNode = m_nodes[node];
+    const Token& token = astNode.token;
+    Glib::ustring ret;
+    switch (token.kind) {
+    case TokenKind::Number:
+        ret = Glib::ustring::sprintf("%g", token.value);
+        break;
+    case TokenKind::Id:
+        ret = get_id(token);
+        break;
+    case TokenKind::Op:
+        ret = Glib::ustring(1, token.op);
+        break;
+    case TokenKind::Negate:
+        ret = "u-";
+        break;
+    case TokenKind::Assign:
+        ret = "=";
+        break;
+    case TokenKind::List:
+        ret = "[]";
+        break;
+    default:
+        ret = "?";
+        break;
+    }
+    if (astNode.first == AstNode::NONE
+     && !token.function) {
+        return ret;
+    }
+    ret = "(" + ret;
+    for (uint32_t operand = astNode.first; operand != AstNode::NONE; operand = m_nodes[operand].next) {
+        ret += " " + show(operand);
+    }
+    return ret + ")";
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glibmm.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "Token.hpp"
+
+/*
+ * a node of the expression tree, the token tells the operation.
+ *   The operands are linked by next, so a function may take
+ *   any number of arguments.
+ */
+struct AstNode
+{
+    static constexpr uint32_t NONE{UINT32_MAX};
+
+    Token token;
+    uint32_t first{NONE};       // first operand
+    uint32_t next{NONE};        // next operand of the same parent
+    uint32_t count{};           // number of operands
+};
+
+/*
+ * tree of a parsed expression as build by Syntax::parse,
+ *   the nodes are kept in one vector and refer to each other by index.
+ *   Keeps a copy of the text the identifiers refer to.
+ *   A assignment is a root with the kind Assign,
+ *   and the id and expression as operands.
+ */
+class Ast
+{
+public:
+    Ast() = default;
+    explicit Ast(std::string_view text);
+
+    uint32_t add(const Token& token);
+    uint32_t add(const Token& token, std::span<const uint32_t> operands);
+    const AstNode& operator[](uint32_t node) const;
+    size_t size() const;
+    uint32_t get_root() const;
+    void set_root(uint32_t root);
+    std::string_view get_text() const;
+
+    Glib::ustring get_id(const Token& token) const;
+    // prefix notation e.g. (+ 1 (* 2 3)) for debugging
+    Glib::ustring show() const;
+    Glib::ustring show(uint32_t node) const;
+private:
+    std::string m_text;
+    std::vector<AstNode> m_nodes;
+    uint32_t m_root{AstNode::NONE};
+};
@@ -17,160 +17,592 @@
  */
 
 #include <iostream>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 #include <psc_format.hpp>
 #include <psc_i18n.hpp>
-#include <StringUtils.hpp>
 
 
 #include "BaseEval.hpp"
+#include "VectorMath.hpp"
+#include "EvalFrame.hpp"
+#include "Optimizer.hpp"
+#include "BoundForm.hpp"
+#include "UserFunction.hpp"
+#include "ListReduction.hpp"
 #include "calcpp_config.h"
 
 BaseEval::BaseEval()
+: m_variables()
 {
 }
 
+bool
+BaseEval::get_variable(const Glib::ustring& name, double* val)
+{
+    size_t slot;
+    if (m_variables.find(name, &slot)
+     && m_variables.is_defined(slot)) {
+        *val = m_variables.get(slot);
+        return true;
+    }
+    *val = 0.0;
+    return false;
+}
 
-// simple check if expression will have one result, and no underrun
-int
-BaseEval::validate(std::list<std::shared_ptr<Token>>& stack)
-{
-	int cnt = 0;
-	for (auto token : stack) {
-		std::shared_ptr<NumToken> numToken = std::dynamic_pointer_cast<NumToken>(token);
-		if (numToken) {
-			++cnt;
-		}
-		std::shared_ptr<IdToken> idToken = std::dynamic_pointer_cast<IdToken>(token);
-		if (idToken) {
-            auto function = getFunction(idToken->getId());
-			if (!function) {
-				++cnt;      // expect var
-			}
-			else {	// function will consume 1 and and add 1, at least for in the momentary state
-				if (cnt < 1) {
-					return 0;
-				}
-			}
-		}
-		std::shared_ptr<OpToken> op = std::dynamic_pointer_cast<OpToken>(token);
-		if (op) {
-			int opCnt = op->is_binary() ? 2 : 1;
-			if (cnt < opCnt) {
-				return 0;
-			}
-			cnt -= opCnt - 1;	// -1 as we add a result
-		}
-		std::shared_ptr<AssignToken> assignToken = std::dynamic_pointer_cast<AssignToken>(token);
-		if (assignToken) {
-			throw EvalError(_("Assignment operator only allowed once"));
-		}
-	}
-	return cnt;
-}
-
-// if this is an assigment return the id it shoud be assigned to.
-//   the stack on return in this case will only contain the expression
-std::shared_ptr<IdToken>
-BaseEval::assign_token(std::list<std::shared_ptr<Token>>& stack)
-{
-	std::shared_ptr<IdToken> idAssignToken;
-	auto iter = stack.begin();
-	if (iter != stack.end()) {
-		idAssignToken = std::dynamic_pointer_cast<IdToken>(*iter);
-		if (idAssignToken) {
-			++iter;
-			if (iter != stack.end()) {
-				std::shared_ptr<AssignToken> assignToken = std::dynamic_pointer_cast<AssignToken>(*iter);
-				if (assignToken) {
-					stack.pop_front();	// keep just expression
-					stack.pop_front();
-				}
-				else {
-					idAssignToken.reset();	// allow simple check later
-				}
-			}
-		}
-	}
-	return idAssignToken;
+void
+BaseEval::set_variable(const Glib::ustring& name, double val)
+{
+    size_t slot = m_variables.intern(name);
+    if (m_variables.is_constant(slot)) {
+        throw EvalError(psc::fmt::vformat(
+                _("No assignment to constant {}")
+                , psc::fmt::make_format_args(name)));
+    }
+    if (m_variables.is_list(slot)) {
+        ++m_compileVersion;
+    }
+    m_variables.set(slot, val);
+    variable_changed(slot);
+}
+
+void
+BaseEval::set_list(const Glib::ustring& name, std::vector<double>&& values)
+{
+    size_t slot = m_variables.intern(name);
+    if (m_variables.is_constant(slot)) {
+        throw EvalError(psc::fmt::vformat(
+                _("No assignment to constant {}")
+                , psc::fmt::make_format_args(name)));
+    }
+    if (!m_variables.is_list(slot)) {
+        ++m_compileVersion;     // the variable was compiled as value
+    }
+    m_variables.set_list(slot, std::move(values));
+    variable_changed(slot);
+}
+
+void
+BaseEval::set_constant(const Glib::ustring& name, double val)
+{
+    size_t slot = m_variables.intern(name);
+    m_variables.set_constant(slot, val);
+    variable_changed(slot);
+}
+
+bool
+BaseEval::is_constant(const Glib::ustring& name) const
+{
+    size_t slot;
+    return m_variables.find(name, &slot)
+        && m_variables.is_constant(slot);
 }
 
 double
-BaseEval::eval(std::list<std::shared_ptr<Token>> stack)
+BaseEval::get_right_angle()
+{
+    return VectorMath::RIGHT_ANGLE;
+}
+
+void
+BaseEval::set_integration_limit(size_t limit)
+{
+    m_integrationLimit = std::max(limit, static_cast<size_t>(1));
+}
+
+size_t
+BaseEval::get_integration_limit() const
+{
+    return m_integrationLimit;
+}
+
+void
+BaseEval::variable_changed(size_t slot)
+{
+}
+
+std::shared_ptr<Function>
+BaseEval::lookup_function(const Glib::ustring& name)
+{
+    auto function = getFunction(name);
+    if (!function) {
+        function = find_user_function(name);
+    }
+    return function;
+}
+
+std::shared_ptr<UserFunction>
+BaseEval::find_user_function(const Glib::ustring& name) const
+{
+    auto iter = std::find_if(m_userFunctions.begin(), m_userFunctions.end()
+            , [&name] (const std::shared_ptr<UserFunction>& function) {
+                return function->get_name() == name;
+            });
+    return iter != m_userFunctions.end() ? *iter : std::shared_ptr<UserFunction>();
+}
+
+// a redefinition keeps the place, so restoring in order
+//   defines a function before those that use it
+void
+BaseEval::define_function(const std::shared_ptr<UserFunction>& function)
+{
+    auto iter = std::find_if(m_userFunctions.begin(), m_userFunctions.end()
+            , [&function] (const std::shared_ptr<UserFunction>& defined) {
+                return defined->get_name() == function->get_name();
+            });
+    if (iter != m_userFunctions.end()) {
+        *iter = function;
+    }
+    else {
+        m_userFunctions.push_back(function);
+    }
+    ++m_compileVersion;
+}
+
+const std::vector<std::shared_ptr<UserFunction>>&
+BaseEval::get_user_functions() const
+{
+    return m_userFunctions;
+}
+
+uint64_t
+BaseEval::get_compile_version() const
+{
+    return m_compileVersion;
+}
+
+
+// translate the output of Syntax::parse into a flat program,
+//   functions are resolved here.
+//   A assignment root stores the result,
+//   a function definition root e.g. f(x) = x^2 defines the function.
+//   The program is passed through the Optimizer before returning.
+//   Identifiers named as params will be bound on evaluation e.g. x for f(x).
+PtrProgram
+BaseEval::compile(const Ast& ast
+                , const std::vector<Glib::ustring>& params)
 {
 #   ifdef DEBUG
-		std::cout << "Stack -------------" << std::endl;
-		for (auto token : stack) {
-			std::cout << token->show() << std::endl;
-		}
-		std::cout << "-------------------" << std::endl;
+        std::cout << "Ast " << ast.show() << std::endl;
 #   endif
-	std::shared_ptr<IdToken> idAssignToken = assign_token(stack);
-	int cnt = validate(stack);
-	if (cnt != 1) {
-		throw EvalError(psc::fmt::vformat(
-                _("The calculation is not balanced {} (expect 1)")
-                , psc::fmt::make_format_args(cnt)));
-	}
-	//#pragma GCC diagnostic push
-	//#pragma GCC diagnostic ignored "-Wno-psabi"		// only supported as compile option
-	std::list<double> values;
-	for (auto token : stack) {
-		std::shared_ptr<NumToken> numToken = std::dynamic_pointer_cast<NumToken>(token);
-		if (numToken) {
-			values.push_back(numToken->getValue());
-		}
-		std::shared_ptr<IdToken> idToken = std::dynamic_pointer_cast<IdToken>(token);
-		if (idToken) {
-            auto function = getFunction(idToken->getId());
-			if (function) {
-				//if (values.empty()) {	consistency was checked before
-				double valueR = values.back();
-				values.pop_back();
-                if (function) {
-					double result = function->eval(valueR, this);
-					values.push_back(result);
+    uint32_t root = ast.get_root();
+    if (ast[root].token.kind == TokenKind::Assign
+     && ast[ast[root].first].token.function) {
+        return compile_definition(ast);
+    }
+    auto program = std::make_shared<Program>();
+    program->set_param_count(params.size());
+    if (ast[root].token.kind == TokenKind::Assign) {
+        const AstNode& assign = ast[root];
+        auto assignName = ast.get_id(ast[assign.first].token);
+        if (std::find(params.begin(), params.end(), assignName) != params.end()) {
+            throw EvalError(psc::fmt::vformat(
+                    _("No assignment to parameter {}")
+                    , psc::fmt::make_format_args(assignName)));
+        }
+        auto slot = m_variables.intern(assignName);
+        if (m_variables.is_constant(slot)) {
+            throw EvalError(psc::fmt::vformat(
+                    _("No assignment to constant {}")
+                    , psc::fmt::make_format_args(assignName)));
+        }
+        program->set_assign(slot);
+        root = ast[assign.first].next;      // keep just expression
+    }
+    std::vector<uint32_t> literals;
+    std::vector<Glib::ustring> lists;
+    find_lists(ast, root, 1, params, literals, lists);
+    if (!literals.empty()
+     || !lists.empty()) {
+        if (!program->is_assign()) {
+            throw EvalError(_("A list has to be reduced e.g. by sum, or assigned"));
+        }
+        program->add_const(0.0);
+        program->set_list(compile_list(ast, ListReduction::Kind::List, root, 1, params));
+        return program;
+    }
+    compile_node(ast, root, params, *program);
+    Optimizer optimizer(this, m_variables);
+    return optimizer.optimize(program);
+}
+
+// the parameter name of a list within a list expression, [ keeps it apart from ids
+Glib::ustring
+BaseEval::row_name(const Glib::ustring& list)
+{
+    return "[" + list;
+}
+
+Glib::ustring
+BaseEval::row_name(uint32_t literal)
+{
+    return row_name(Glib::ustring(std::to_string(literal)));
+}
+
+// the literals and list variables within the count expressions from first,
+//   without those of reductions, that have their own
+void
+BaseEval::find_lists(const Ast& ast, uint32_t first, size_t count
+                   , const std::vector<Glib::ustring>& params
+                   , std::vector<uint32_t>& literals, std::vector<Glib::ustring>& lists)
+{
+    std::vector<uint32_t> pending;
+    for (uint32_t expr = first; count > 0; expr = ast[expr].next, --count) {
+        pending.push_back(expr);
+    }
+    while (!pending.empty()) {
+        uint32_t current = pending.back();
+        pending.pop_back();
+        const AstNode& node = ast[current];
+        ListReduction::Kind kind;
+        if (node.token.kind == TokenKind::List) {
+            literals.push_back(current);
+            continue;       // the elements are values
+        }
+        if (node.token.kind == TokenKind::Id) {
+            auto id = ast.get_id(node.token);
+            size_t slot;
+            if (node.token.function
+             && ListReduction::find(id, node.count, &kind)) {
+                continue;
+            }
+            if (!node.token.function
+             && std::find(params.begin(), params.end(), id) == params.end()
+             && m_variables.find(id, &slot)
+             && m_variables.is_list(slot)
+             && std::find(lists.begin(), lists.end(), id) == lists.end()) {
+                lists.push_back(id);
+            }
+        }
+        for (uint32_t operand = node.first; operand != AstNode::NONE; operand = ast[operand].next) {
+            pending.push_back(operand);
+        }
+    }
+}
+
+// the count expressions from first evaluated element wise,
+//   each list becomes a row parameter following params,
+//   the rows of a enclosing list expression are hidden
+//   e.g. for data - mean(data) the mean is over all of data
+std::shared_ptr<ListReduction>
+BaseEval::compile_list(const Ast& ast, ListReduction::Kind kind, uint32_t first, size_t count
+                     , const std::vector<Glib::ustring>& params)
+{
+    std::vector<Glib::ustring> bound;
+    for (auto& param : params) {
+        bound.push_back(param.raw().starts_with('[') ? Glib::ustring() : param);
+    }
+    std::vector<uint32_t> literals;
+    std::vector<Glib::ustring> lists;
+    find_lists(ast, first, count, bound, literals, lists);
+    Optimizer optimizer(this, m_variables);
+    std::vector<ListReduction::Input> inputs;
+    auto names = bound;
+    for (auto literal : literals) {
+        ListReduction::Input input;
+        input.literal = true;
+        for (uint32_t element = ast[literal].first; element != AstNode::NONE; element = ast[element].next) {
+            auto program = std::make_shared<Program>();
+            program->set_param_count(bound.size());
+            compile_node(ast, element, bound, *program);
+            input.elements.push_back(optimizer.optimize(program));
+        }
+        inputs.push_back(std::move(input));
+        names.push_back(row_name(literal));
+    }
+    for (auto& list : lists) {
+        ListReduction::Input input;
+        m_variables.find(list, &input.slot);
+        inputs.push_back(std::move(input));
+        names.push_back(row_name(list));
+    }
+    std::vector<PtrProgram> expressions;
+    uint32_t expr = first;
+    for (size_t i = 0; i < count; ++i) {
+        auto program = std::make_shared<Program>();
+        program->set_param_count(names.size());
+        compile_node(ast, expr, names, *program);
+        expressions.push_back(optimizer.optimize(program));
+        expr = ast[expr].next;
+    }
+    return std::make_shared<ListReduction>(kind, std::move(expressions), std::move(inputs), bound.size());
+}
+
+// append the code for the subtree at start
+void
+BaseEval::compile_node(const Ast& ast, uint32_t start
+                     , const std::vector<Glib::ustring>& params, Program& program)
+{
+    // walk the tree in post order, without recursion as long sums build deep trees
+    struct Visit
+    {
+        uint32_t node;
+        bool expanded;
+    };
+    std::vector<Visit> pending{{start, false}};
+    while (!pending.empty()) {
+        Visit visit = pending.back();
+        pending.pop_back();
+        const AstNode& node = ast[visit.node];
+        if (node.token.kind == TokenKind::List) {
+            auto row = std::find(params.begin(), params.end(), row_name(visit.node));
+            if (row == params.end()) {
+                throw EvalError(_("A list has to be reduced e.g. by sum, or assigned"));
+            }
+            program.add_param(static_cast<size_t>(std::distance(params.begin(), row)));
+            continue;
+        }
+        if (!visit.expanded
+         && node.first != AstNode::NONE) {
+            ListReduction::Kind kind;
+            if (node.token.function
+             && ListReduction::find(ast.get_id(node.token), node.count, &kind)) {
+                program.add_reduction(compile_list(ast, kind, node.first, node.count, params));
+                continue;
+            }
+            if (node.token.function) {
+                auto user = find_user_function(ast.get_id(node.token));
+                if (user
+                 && inline_call(ast, visit.node, *user, params, program)) {
+                    continue;
                 }
-                else {
-                    auto idTokenName = idToken->show();
-					throw EvalError(psc::fmt::vformat(
+            }
+            pending.push_back(Visit{visit.node, true});
+            if (node.token.function
+             && BoundForm::is_form(ast.get_id(node.token))) {
+                // the body is compiled on its own, just the bounds are operands
+                auto id = ast.get_id(node.token);
+                if (node.count != BoundForm::ARGUMENTS) {
+                    throw EvalError(psc::fmt::vformat(
+                            _("The function {} expects four arguments")
+                            , psc::fmt::make_format_args(id)));
+                }
+                uint32_t from = ast[ast[node.first].next].next;
+                pending.push_back(Visit{ast[from].next, false});
+                pending.push_back(Visit{from, false});
+                continue;
+            }
+            size_t mark = pending.size();
+            for (uint32_t operand = node.first; operand != AstNode::NONE; operand = ast[operand].next) {
+                pending.push_back(Visit{operand, false});
+            }
+            std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(mark), pending.end());
+            continue;
+        }
+        const Token& token = node.token;
+        switch (token.kind) {
+        case TokenKind::Number:
+            program.add_const(token.value);
+            break;
+        case TokenKind::Id: {
+            auto id = ast.get_id(token);
+            if (token.function
+             && BoundForm::is_form(id)) {
+                program.add_form(compile_form(ast, visit.node, params));
+            }
+            else if (token.function) {
+                auto function = lookup_function(id);
+                if (!function) {
+                    throw EvalError(psc::fmt::vformat(
                             _("No function named {}")
-                            , psc::fmt::make_format_args(idTokenName)));
-				}
-			}
-			else {
-				double val = 0.0;
-				if (!get_variable(idToken->getId(), &val)) {
-                    auto idTokenName = idToken->show();
-					throw EvalError(psc::fmt::vformat(
-                            _("No variable named {}")
-                            , psc::fmt::make_format_args(idTokenName)));
-				}
-				values.push_back(val);
-			}
-		}
-		std::shared_ptr<OpToken> op = std::dynamic_pointer_cast<OpToken>(token);
-		if (op) {
-			//if (values.empty()) {	consistency was checked before
-			double valueR = values.back();
-			values.pop_back();
-			double valueL = valueR;
-			if (op->is_binary()) {
-				//if (values.empty()) {	consistency was checked before
-				valueL = values.back();
-				values.pop_back();
-			}
-			double result = op->eval(valueL, valueR);
-			values.push_back(result);
-		}
-	}
-	//if (values.empty()) {	consistency was checked before
-	double total = values.back();
-	if (idAssignToken) {	// if this was a assignment assign value
+                            , psc::fmt::make_format_args(id)));
+                }
+                size_t arity = function->get_arity();
+                if (node.count != arity) {
+                    if (arity == 1) {
+                        throw EvalError(psc::fmt::vformat(
+                                _("The function {} expects one argument")
+                                , psc::fmt::make_format_args(id)));
+                    }
+                    throw EvalError(psc::fmt::vformat(
+                            _("The function {} expects {} arguments")
+                            , psc::fmt::make_format_args(id, arity)));
+                }
+                program.add_call(function, arity);
+            }
+            else {
+                auto param = std::find(params.begin(), params.end(), id);
+                size_t slot;
+                if (param != params.end()) {
+                    program.add_param(static_cast<size_t>(std::distance(params.begin(), param)));
+                }
+                else if (m_variables.find(id, &slot)
+                      && m_variables.is_list(slot)) {
+                    // a list is a row parameter of the enclosing list expression
+                    auto row = std::find(params.begin(), params.end(), row_name(id));
+                    if (row == params.end()) {
+                        throw EvalError(psc::fmt::vformat(
+                                _("The list {} has to be reduced e.g. by sum")
+                                , psc::fmt::make_format_args(id)));
+                    }
+                    program.add_param(static_cast<size_t>(std::distance(params.begin(), row)));
+                }
+                else {
+                    program.add_load(m_variables.intern(id));
+                }
+            }
+            break;
+        }
+        case TokenKind::Op:
+        case TokenKind::Negate:
+            program.add_op(token.code);
+            break;
+        default:            // the parser allows assignment only at the root
+            throw EvalError(_("Assignment operator only allowed once"));
+        }
+    }
+}
+
+// the body gets the variable as first parameter, before the params of the enclosing
+//   expression, so the variable hides a param or variable of the same name
+std::shared_ptr<BoundForm>
+BaseEval::compile_form(const Ast& ast, uint32_t node
+                     , const std::vector<Glib::ustring>& params)
+{
+    auto id = ast.get_id(ast[node].token);
+    uint32_t body = ast[node].first;
+    const AstNode& variable = ast[ast[body].next];
+    if (variable.token.kind != TokenKind::Id
+     || variable.token.function) {
+        throw EvalError(psc::fmt::vformat(
+                _("The function {} expects a variable name as second argument")
+                , psc::fmt::make_format_args(id)));
+    }
+    std::vector<Glib::ustring> bound{ast.get_id(variable.token)};
+    bound.insert(bound.end(), params.begin(), params.end());
+    auto program = std::make_shared<Program>();
+    program->set_param_count(bound.size());
+    compile_node(ast, body, bound, *program);
+    Optimizer optimizer(this, m_variables);
+    return BoundForm::create(id, optimizer.optimize(program));
+}
+
+// the definition is compiled, but the function is defined on evaluation
+PtrProgram
+BaseEval::compile_definition(const Ast& ast)
+{
+    const AstNode& assign = ast[ast.get_root()];
+    const AstNode& head = ast[assign.first];
+    auto name = ast.get_id(head.token);
+    if (getFunction(name)
+     || BoundForm::is_form(name)
+     || ListReduction::is_reduction(name)) {
+        throw EvalError(psc::fmt::vformat(
+                _("No definition of builtin function {}")
+                , psc::fmt::make_format_args(name)));
+    }
+    std::vector<Glib::ustring> params;
+    for (uint32_t param = head.first; param != AstNode::NONE; param = ast[param].next) {
+        auto id = ast.get_id(ast[param].token);
+        if (std::find(params.begin(), params.end(), id) != params.end()) {
+            throw EvalError(psc::fmt::vformat(
+                    _("The parameter {} is used twice")
+                    , psc::fmt::make_format_args(id)));
+        }
+        params.push_back(id);
+    }
+    auto body = std::make_shared<Program>();
+    body->set_param_count(params.size());
+    compile_node(ast, head.next, params, *body);
+    Optimizer optimizer(this, m_variables);
+    auto text = ast.get_text();
+    auto first = text.find_first_not_of(" \t");
+    auto last = text.find_last_not_of(" \t\r\n");
+    Glib::ustring definition{first != std::string_view::npos
+                             ? std::string(text.substr(first, last - first + 1))
+                             : std::string()};
+    auto program = std::make_shared<Program>();
+    program->add_const(0.0);
+    program->set_define(std::make_shared<UserFunction>(name, params, optimizer.optimize(body), body, definition));
+    return program;
+}
+
+// the body of a small user function replaces the call, so the Optimizer
+//   sees e.g. constant arguments, false if a argument would be evaluated
+//   more than once, as it is used more than once and is more than a value
+bool
+BaseEval::inline_call(const Ast& ast, uint32_t call, const UserFunction& function
+                    , const std::vector<Glib::ustring>& params, Program& program)
+{
+    const Program& body = *function.get_source();
+    if (!function.is_inline()
+     || ast[call].count != body.get_param_count()) {
+        return false;
+    }
+    std::vector<size_t> uses(body.get_param_count());
+    for (auto& instr : body.get_code()) {
+        if (instr.code == OpCode::Param) {
+            ++uses[instr.index];
+        }
+    }
+    std::vector<Program> args(body.get_param_count());
+    uint32_t operand = ast[call].first;
+    for (size_t arg = 0; arg < args.size(); ++arg) {
+        compile_node(ast, operand, params, args[arg]);
+        if (uses[arg] > 1
+         && args[arg].get_code().size() > 1) {
+            return false;
+        }
+        operand = ast[operand].next;
+    }
+    for (auto& instr : body.get_code()) {
+        if (instr.code == OpCode::Param) {
+            auto& arg = args[instr.index];
+            for (auto& argInstr : arg.get_code()) {
+                program.add(argInstr, arg);
+            }
+        }
+        else {
+            program.add(instr, body);
+        }
+    }
+    return true;
+}
+
+double
+BaseEval::eval(const Ast& ast)
+{
+    return eval(compile(ast));
+}
+
+double
+BaseEval::eval(const PtrProgram& program, std::span<const double> params)
+{
+    EvalFrame frame(*this);
+    if (program->get_list()) {      // assign a list, the result is the count
+        auto values = program->get_list()->eval_list(params, frame);
+        double count = static_cast<double>(values.size());
+        set_list(m_variables.get_name(program->get_assign()), std::move(values));
+        return count;
+    }
+	double total = frame.eval(*program, params);
+    if (program->get_define()) {
+        define_function(program->get_define());
+    }
+	if (program->is_assign()) {	// if this was a assignment assign value
 #		ifdef DEBUG
-			std::cout << "Set " << idAssignToken->getId() << " = " << total << std::endl;
+			std::cout << "Set " << m_variables.get_name(program->get_assign()) << " = " << total << std::endl;
 #       endif
-		set_variable(idAssignToken->getId(), total);
+        if (m_variables.is_list(program->get_assign())) {
+            ++m_compileVersion;     // the variable was compiled as list
+        }
+        m_variables.set(program->get_assign(), total);
+        variable_changed(program->get_assign());
 	}
-	//#pragma GCC diagnostic pop
 	return total;
 }
+
+void
+BaseEval::eval_batch(const PtrProgram& program, std::span<const double> input, std::span<double> output)
+{
+    EvalFrame frame(*this);
+    frame.eval_batch(*program, input, output);
+}
+
+const VariableStore&
+BaseEval::get_variables() const
+{
+    return m_variables;
+}
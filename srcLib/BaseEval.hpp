@@ -18,12 +18,20 @@
 
 #pragma once
 
-#include <list>
 #include <memory>
+#include <vector>
+#include <span>
 
 
 #include "Token.hpp"
+#include "Ast.hpp"
 #include "Function.hpp"
+#include "Program.hpp"
+#include "VariableStore.hpp"
+#include "ListReduction.hpp"
+
+class BoundForm;
+class UserFunction;
 
 class BaseEval
 {
@@ -32,19 +40,65 @@ public:
     explicit BaseEval(const BaseEval& orig) = delete;
     virtual ~BaseEval() = default;
 
-    double eval(std::list<std::shared_ptr<Token>> stack);
+    double eval(const Ast& ast);
+    double eval(const PtrProgram& program, std::span<const double> params = {});
+    void eval_batch(const PtrProgram& program, std::span<const double> input, std::span<double> output);
+    PtrProgram compile(const Ast& ast
+                     , const std::vector<Glib::ustring>& params = {});
+    // the builtin functions
     virtual std::shared_ptr<Function> getFunction(const Glib::ustring& name) = 0;
-    virtual bool get_variable(const Glib::ustring& name, double* val) = 0;
-    virtual void set_variable(const Glib::ustring& name, double val) = 0;
-    virtual double toRadian(double val) = 0;
-    virtual double fromRadian(double val) = 0;
+    // a builtin or user defined function, nullptr if there is none
+    std::shared_ptr<Function> lookup_function(const Glib::ustring& name);
+    // replaces a function of the same name
+    void define_function(const std::shared_ptr<UserFunction>& function);
+    // by the order of definition
+    const std::vector<std::shared_ptr<UserFunction>>& get_user_functions() const;
+    // changes with each definition, or if a variable changes between
+    //   value and list, so compiled programs e.g. in a cache are known to be outdated
+    uint64_t get_compile_version() const;
+    virtual bool get_variable(const Glib::ustring& name, double* val);
+    virtual void set_variable(const Glib::ustring& name, double val);
+    // replaces a value or list of the same name
+    void set_list(const Glib::ustring& name, std::vector<double>&& values);
+    // a constant can't be changed, and gets folded on compile
+    void set_constant(const Glib::ustring& name, double val);
+    bool is_constant(const Glib::ustring& name) const;
+    // the angle unit as size of a right angle
+    virtual double get_right_angle();
+    // subintervals used by integrate at most
+    void set_integration_limit(size_t limit);
+    size_t get_integration_limit() const;
+    // read-only, e.g. for EvalFrame
+    const VariableStore& get_variables() const;
+
+    static constexpr size_t INTEGRATION_LIMIT{1000};
 
 protected:
 
-    std::shared_ptr<IdToken> assign_token(std::list<std::shared_ptr<Token>>& stack);
-    int validate(std::list<std::shared_ptr<Token>>& stack);
+    // notify a value change e.g. to update a display
+    virtual void variable_changed(size_t slot);
 
+    VariableStore m_variables;
 private:
+    void compile_node(const Ast& ast, uint32_t start
+                    , const std::vector<Glib::ustring>& params, Program& program);
+    std::shared_ptr<BoundForm> compile_form(const Ast& ast, uint32_t node
+                                          , const std::vector<Glib::ustring>& params);
+    PtrProgram compile_definition(const Ast& ast);
+    bool inline_call(const Ast& ast, uint32_t call, const UserFunction& function
+                   , const std::vector<Glib::ustring>& params, Program& program);
+    std::shared_ptr<UserFunction> find_user_function(const Glib::ustring& name) const;
+    void find_lists(const Ast& ast, uint32_t first, size_t count
+                  , const std::vector<Glib::ustring>& params
+                  , std::vector<uint32_t>& literals, std::vector<Glib::ustring>& lists);
+    std::shared_ptr<ListReduction> compile_list(const Ast& ast, ListReduction::Kind kind
+                                              , uint32_t first, size_t count
+                                              , const std::vector<Glib::ustring>& params);
+    static Glib::ustring row_name(const Glib::ustring& list);
+    static Glib::ustring row_name(uint32_t literal);
 
+    size_t m_integrationLimit{INTEGRATION_LIMIT};
+    std::vector<std::shared_ptr<UserFunction>> m_userFunctions;
+    uint64_t m_compileVersion{};
 };
 
@@ -0,0 +1,666 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <array>
+#include <future>
+#include <thread>
+#include <psc_format.hpp>
+#include <psc_i18n.hpp>
+
+#include "BoundForm.hpp"
+#include "EvalFrame.hpp"
+#include "Token.hpp"
+#include "VectorMath.hpp"
+
+namespace {
+
+// the Kronrod nodes in (0, 1] descending, the odd ones
+//   are the Gauss nodes, the center is not included
+constexpr std::array<double, 7> KRONROD_NODES{
+     0.991455371120812639206854697526329
+    ,0.949107912342758524526189684047851
+    ,0.864864423359769072789712788640926
+    ,0.741531185599394439863864773280788
+    ,0.586087235467691130294144845693013
+    ,0.405845151377397166906606412076961
+    ,0.207784955007898467600689403773245};
+// weights by node, the last for the center
+constexpr std::array<double, 8> KRONROD_WEIGHTS{
+     0.022935322010529224963732008058970
+    ,0.063092092629978553290700663189204
+    ,0.104790010322250183839876322541518
+    ,0.140653259715525918745189590510238
+    ,0.169004726639267902826583426598550
+    ,0.190350578064785409913256402421014
+    ,0.204432940075298892414161999234649
+    ,0.209482141084727828012999174891714};
+constexpr std::array<double, 4> GAUSS_WEIGHTS{
+     0.129484966168869693270611432679082
+    ,0.279705391489276667901467771423780
+    ,0.381830050505118944950369775488975
+    ,0.417959183673469387755102040816327};
+
+}
+
+BoundForm::BoundForm(const PtrProgram& body)
+: m_body{body}
+{
+}
+
+const PtrProgram&
+BoundForm::get_body() const
+{
+    return m_body;
+}
+
+Interval
+BoundForm::eval_interval(const Interval& from, const Interval& to
+                       , std::span<const Interval> params, EvalFrame& frame)
+{
+    if (from.is_empty() || to.is_empty()) {
+        return Interval::empty();
+    }
+    if (!from.is_point() || !to.is_point()) {
+        return Interval::entire();
+    }
+    std::vector<double> values;
+    for (auto& param : params) {
+        if (param.is_empty()) {
+            return Interval::empty();
+        }
+        if (!param.is_point()) {
+            return Interval::entire();
+        }
+        values.push_back(param.lo);
+    }
+    double val = eval(from.lo, to.lo, values, frame);
+    return std::isnan(val) ? Interval::empty() : Interval::outward(val, val, 2);
+}
+
+// the derivatives give the direction, so e.g. with
+//   from = x and to = x^2 this is the total derivative by x
+Dual
+BoundForm::eval_dual(const Dual& from, const Dual& to
+                   , std::span<const Dual> params, EvalFrame& frame)
+{
+    std::vector<double> values;
+    std::vector<double> direction;
+    double magnitude = std::max({1.0, std::abs(from.val), std::abs(to.val)});
+    bool constant = from.der == 0.0 && to.der == 0.0;
+    for (auto& param : params) {
+        values.push_back(param.val);
+        direction.push_back(param.der);
+        magnitude = std::max(magnitude, std::abs(param.val));
+        constant = constant && param.der == 0.0;
+    }
+    double val = eval(from.val, to.val, values, frame);
+    if (constant) {
+        return Dual(val);
+    }
+    double step = std::cbrt(std::numeric_limits<double>::epsilon()) * magnitude;
+    auto shifted = [&] (double by) {
+        std::vector<double> moved(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            moved[i] = values[i] + by * direction[i];
+        }
+        return eval(from.val + by * from.der, to.val + by * to.der, moved, frame);
+    };
+    return Dual(val, (shifted(step) - shifted(-step)) / (2.0 * step));
+}
+
+bool
+BoundForm::is_form(const Glib::ustring& name)
+{
+    return name == "solve"
+        || name == "integrate"
+        || name == "sum"
+        || name == "prod";
+}
+
+std::shared_ptr<BoundForm>
+BoundForm::create(const Glib::ustring& name, const PtrProgram& body)
+{
+    if (name == "solve") {
+        return std::make_shared<FormSolve>(body);
+    }
+    if (name == "integrate") {
+        return std::make_shared<FormIntegrate>(body);
+    }
+    if (name == "sum" || name == "prod") {
+        return std::make_shared<FormSeries>(body, name == "prod");
+    }
+    return std::shared_ptr<BoundForm>();
+}
+
+std::vector<double>
+BoundForm::bind(double at, std::span<const double> params) const
+{
+    std::vector<double> bound;
+    bound.reserve(params.size() + 1);
+    bound.push_back(at);
+    bound.insert(bound.end(), params.begin(), params.end());
+    return bound;
+}
+
+
+
+FormSolve::FormSolve(const PtrProgram& body)
+: BoundForm(body)
+{
+}
+
+double
+FormSolve::eval(double from, double to, std::span<const double> params, EvalFrame& frame)
+{
+    auto found = roots(from, to, params, frame, 1);
+    if (found.empty()) {
+        throw EvalError(psc::fmt::vformat(
+                _("No root found between {} and {}")
+                , psc::fmt::make_format_args(from, to)));
+    }
+    return found.front();
+}
+
+// the segments are processed from the left, so the roots come ascending
+std::vector<double>
+FormSolve::roots(double from, double to, std::span<const double> params
+               , EvalFrame& frame, size_t limit)
+{
+    if (!std::isfinite(from) || !std::isfinite(to)) {
+        throw EvalError(_("The range to solve has to be finite"));
+    }
+    if (from > to) {
+        std::swap(from, to);
+    }
+    std::vector<double> found;
+    auto add = [&found] (double root) {
+        if (found.empty()
+         || root - found.back() > 4.0 * std::numeric_limits<double>::epsilon() * std::abs(root)) {
+            found.push_back(root);
+        }
+    };
+    std::vector<double> scan(SCAN_SEGMENTS + 1);
+    double scale = 0.0;
+    for (size_t i = 0; i <= SCAN_SEGMENTS; ++i) {
+        double at = i < SCAN_SEGMENTS
+                    ? from + (to - from) * static_cast<double>(i) / static_cast<double>(SCAN_SEGMENTS)
+                    : to;
+        scan[i] = value(at, params, frame);
+        if (std::isfinite(scan[i])) {
+            scale = std::max(scale, std::abs(scan[i]));
+        }
+    }
+    std::vector<Segment> pending;
+    for (size_t i = SCAN_SEGMENTS; i > 0; --i) {
+        double lo = from + (to - from) * static_cast<double>(i - 1) / static_cast<double>(SCAN_SEGMENTS);
+        double hi = i < SCAN_SEGMENTS
+                    ? from + (to - from) * static_cast<double>(i) / static_cast<double>(SCAN_SEGMENTS)
+                    : to;
+        pending.push_back(Segment{lo, hi, scan[i - 1], scan[i], 0});
+    }
+    while (!pending.empty()
+        && found.size() < limit) {
+        Segment segment = pending.back();
+        pending.pop_back();
+        if (segment.flo == 0.0) {
+            add(segment.lo);
+            continue;
+        }
+        Interval enclosure = enclose(segment, params, frame);
+        if (enclosure.is_empty()
+         || !enclosure.contains(0.0)) {
+            continue;       // proven to be free of roots
+        }
+        if (segment.flo * segment.fhi < 0.0) {
+            double root = bracketed(segment, params, frame);
+            // a pole changes sign as well, but grows towards it
+            if (std::abs(value(root, params, frame)) <= std::min(std::abs(segment.flo), std::abs(segment.fhi))) {
+                add(root);
+            }
+            continue;
+        }
+        if (!enclosure.is_bounded()) {
+            continue;       // nothing to learn from splitting e.g. at a pole
+        }
+        if (segment.level < SPLIT_LEVELS) {
+            double mid = segment.lo + (segment.hi - segment.lo) / 2.0;
+            double fmid = value(mid, params, frame);
+            pending.push_back(Segment{mid, segment.hi, fmid, segment.fhi, segment.level + 1});
+            pending.push_back(Segment{segment.lo, mid, segment.flo, fmid, segment.level + 1});
+            continue;
+        }
+        double root;
+        if (touching(segment, scale, params, frame, &root)) {
+            add(root);
+        }
+    }
+    if (scan[SCAN_SEGMENTS] == 0.0
+     && found.size() < limit) {
+        add(to);
+    }
+    return found;
+}
+
+double
+FormSolve::value(double at, std::span<const double> params, EvalFrame& frame)
+{
+    auto bound = bind(at, params);
+    return frame.eval(*m_body, bound);
+}
+
+Dual
+FormSolve::derivative(double at, std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<Dual> bound{Dual(at, 1.0)};
+    for (double param : params) {
+        bound.push_back(Dual(param));
+    }
+    return frame.eval_dual(*m_body, bound);
+}
+
+Interval
+FormSolve::enclose(const Segment& segment, std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<Interval> bound{Interval(segment.lo, segment.hi)};
+    for (double param : params) {
+        bound.push_back(Interval(param));
+    }
+    return frame.eval_interval(*m_body, bound);
+}
+
+// Newton steps that are kept within the bracket,
+//   a step that leaves it or does not halve the previous
+//   one is replaced by bisection (as rtsafe)
+double
+FormSolve::bracketed(const Segment& segment, std::span<const double> params, EvalFrame& frame)
+{
+    double lo = segment.lo;
+    double hi = segment.hi;
+    const bool rising = segment.flo < 0.0;
+    double x = lo + (hi - lo) / 2.0;
+    double lastStep = hi - lo;
+    for (int i = 0; i < ITERATION_LIMIT; ++i) {
+        Dual fx = derivative(x, params, frame);
+        if (fx.val == 0.0) {
+            return x;
+        }
+        if (std::isnan(fx.val)) {
+            return NAN;
+        }
+        if ((fx.val < 0.0) == rising) {
+            lo = x;
+        }
+        else {
+            hi = x;
+        }
+        double next = x - fx.val / fx.der;
+        if (!(next > lo && next < hi)
+         || std::abs(next - x) > lastStep / 2.0) {
+            next = lo + (hi - lo) / 2.0;
+        }
+        lastStep = std::abs(next - x);
+        if (lastStep <= 2.0 * std::numeric_limits<double>::epsilon() * std::abs(next)
+         || next == lo || next == hi) {
+            return next;
+        }
+        x = next;
+    }
+    return x;
+}
+
+// the segment is within the enclosure of a root, but without sign change
+bool
+FormSolve::touching(const Segment& segment, double scale, std::span<const double> params
+                  , EvalFrame& frame, double* root)
+{
+    double x = std::abs(segment.flo) < std::abs(segment.fhi) ? segment.lo : segment.hi;
+    for (int i = 0; i < ITERATION_LIMIT; ++i) {
+        Dual fx = derivative(x, params, frame);
+        if (std::abs(fx.val) <= TOUCH_TOLERANCE * scale) {
+            *root = x;
+            return true;
+        }
+        if (fx.der == 0.0
+         || !std::isfinite(fx.val)) {
+            return false;
+        }
+        x -= fx.val / fx.der;
+        if (!(x >= segment.lo && x <= segment.hi)) {
+            return false;       // a root of a neighbour, or none
+        }
+    }
+    return false;
+}
+
+
+
+FormIntegrate::FormIntegrate(const PtrProgram& body)
+: BoundForm(body)
+{
+}
+
+double
+FormIntegrate::eval(double from, double to, std::span<const double> params, EvalFrame& frame)
+{
+    if (std::isnan(from) || std::isnan(to)) {
+        return NAN;
+    }
+    if (from == to) {
+        return 0.0;
+    }
+    double sign = 1.0;
+    if (from > to) {
+        std::swap(from, to);
+        sign = -1.0;
+    }
+    const Range range{from, to};
+    const double width = range.end() - range.start();
+    const size_t limit = frame.get_integration_limit();
+    std::vector<Part> parts{Part{range.start(), range.end()}};
+    evaluate(parts, range, params, frame);
+    while (true) {
+        double total = 0.0;
+        double error = 0.0;
+        double abs = 0.0;
+        for (auto& part : parts) {
+            total += part.sum;
+            error += part.error;
+            abs += part.abs;
+        }
+        double tolerance = std::max(REL_TOLERANCE * std::abs(total)
+                                  , ROUNDING_TOLERANCE * std::numeric_limits<double>::epsilon() * abs);
+        if (!std::isfinite(total)
+         || error <= tolerance
+         || parts.size() >= limit) {
+            return sign * total;
+        }
+        // the parts that have more than their share of the tolerance
+        std::vector<size_t> split;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            double mid = parts[i].lo + (parts[i].hi - parts[i].lo) / 2.0;
+            if (parts[i].error > tolerance * (parts[i].hi - parts[i].lo) / width
+             && mid > parts[i].lo && mid < parts[i].hi) {
+                split.push_back(i);
+            }
+        }
+        if (split.empty()) {
+            return sign * total;        // as good as it gets
+        }
+        size_t room = limit - parts.size();
+        if (split.size() > room) {
+            std::nth_element(split.begin(), split.begin() + static_cast<std::ptrdiff_t>(room), split.end(),
+                [&parts] (size_t left, size_t right) {
+                    return parts[left].error > parts[right].error;
+                });
+            split.resize(room);
+        }
+        std::vector<Part> halves;
+        halves.reserve(split.size() * 2);
+        for (size_t i : split) {
+            double mid = parts[i].lo + (parts[i].hi - parts[i].lo) / 2.0;
+            halves.push_back(Part{parts[i].lo, mid});
+            halves.push_back(Part{mid, parts[i].hi});
+            parts[i].hi = parts[i].lo;      // mark as replaced
+        }
+        evaluate(halves, range, params, frame);
+        std::erase_if(parts, [] (const Part& part) { return part.hi == part.lo; });
+        parts.insert(parts.end(), halves.begin(), halves.end());
+    }
+}
+
+// the nodes of all parts are evaluated at once
+void
+FormIntegrate::evaluate(std::span<Part> parts, const Range& range
+                      , std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<double> x(parts.size() * NODES);
+    std::vector<double> jacobian(x.size());
+    for (size_t p = 0; p < parts.size(); ++p) {
+        double center = parts[p].lo + (parts[p].hi - parts[p].lo) / 2.0;
+        double half = (parts[p].hi - parts[p].lo) / 2.0;
+        size_t base = p * NODES;
+        x[base] = range.map(center, &jacobian[base]);
+        for (size_t j = 0; j < KRONROD_NODES.size(); ++j) {
+            size_t node = base + 1 + 2 * j;
+            x[node] = range.map(center - half * KRONROD_NODES[j], &jacobian[node]);
+            x[node + 1] = range.map(center + half * KRONROD_NODES[j], &jacobian[node + 1]);
+        }
+    }
+    std::vector<double> y(x.size());
+    evaluate_nodes(x, y, params, frame);
+    for (size_t p = 0; p < parts.size(); ++p) {
+        const double* f = y.data() + p * NODES;
+        const double* jac = jacobian.data() + p * NODES;
+        double center = f[0] * jac[0];
+        double kronrod = KRONROD_WEIGHTS[7] * center;
+        double gauss = GAUSS_WEIGHTS[3] * center;
+        double abs = KRONROD_WEIGHTS[7] * std::abs(center);
+        for (size_t j = 0; j < KRONROD_NODES.size(); ++j) {
+            double left = f[1 + 2 * j] * jac[1 + 2 * j];
+            double right = f[2 + 2 * j] * jac[2 + 2 * j];
+            kronrod += KRONROD_WEIGHTS[j] * (left + right);
+            abs += KRONROD_WEIGHTS[j] * (std::abs(left) + std::abs(right));
+            if (j % 2 == 1) {
+                gauss += GAUSS_WEIGHTS[j / 2] * (left + right);
+            }
+        }
+        double half = (parts[p].hi - parts[p].lo) / 2.0;
+        parts[p].sum = kronrod * half;
+        parts[p].error = std::abs(kronrod - gauss) * half;
+        parts[p].abs = abs * half;
+    }
+}
+
+// large levels are split into chunks, evaluated by detached copies of the frame
+void
+FormIntegrate::evaluate_nodes(std::span<const double> x, std::span<double> y
+                            , std::span<const double> params, EvalFrame& frame)
+{
+    size_t chunks = std::clamp(x.size() / CHUNK_MIN
+                             , static_cast<size_t>(1)
+                             , static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)));
+    size_t len = (x.size() + chunks - 1) / chunks;
+    std::vector<std::future<void>> tasks;
+    for (size_t start = len; start < x.size(); start += len) {
+        size_t count = std::min(len, x.size() - start);
+        tasks.push_back(std::async(std::launch::async,
+            [this, x, y, params, start, count, copy = frame.copy_detached()] {
+                copy->eval_batch(*m_body, x.subspan(start, count), y.subspan(start, count), params);
+            }));
+    }
+    frame.eval_batch(*m_body, x.first(std::min(len, x.size())), y.first(std::min(len, x.size())), params);
+    for (auto& task : tasks) {
+        task.get();     // rethrows e.g. a EvalError
+    }
+}
+
+double
+FormIntegrate::Range::start() const
+{
+    if (std::isfinite(from)) {
+        return std::isfinite(to) ? from : 0.0;
+    }
+    return std::isfinite(to) ? 0.0 : -1.0;
+}
+
+double
+FormIntegrate::Range::end() const
+{
+    return std::isfinite(to) && std::isfinite(from) ? to : 1.0;
+}
+
+// [from, inf) by x = from + t / (1 - t), (-inf, to] by x = to - t / (1 - t)
+//   with t in [0, 1), (-inf, inf) by x = t / (1 - t^2) with t in (-1, 1),
+//   the nodes are within the range, so never at the singular end
+double
+FormIntegrate::Range::map(double t, double* jacobian) const
+{
+    if (std::isfinite(from) && std::isfinite(to)) {
+        *jacobian = 1.0;
+        return t;
+    }
+    if (std::isfinite(from)) {
+        double scale = 1.0 / (1.0 - t);
+        *jacobian = scale * scale;
+        return from + t * scale;
+    }
+    if (std::isfinite(to)) {
+        double scale = 1.0 / (1.0 - t);
+        *jacobian = scale * scale;
+        return to - t * scale;
+    }
+    double scale = 1.0 / (1.0 - t * t);
+    *jacobian = (1.0 + t * t) * scale * scale;
+    return t * scale;
+}
+
+
+
+FormSeries::FormSeries(const PtrProgram& body, bool product)
+: BoundForm(body)
+, m_product{product}
+{
+}
+
+// the empty sum is 0, the empty product 1
+double
+FormSeries::eval(double from, double to, std::span<const double> params, EvalFrame& frame)
+{
+    if (!std::isfinite(from) || !std::isfinite(to)) {
+        throw EvalError(_("The range of a sum or product has to be finite"));
+    }
+    double first = std::ceil(from);
+    double last = std::floor(to);
+    double terms = last - first + 1.0;
+    if (terms > TERM_LIMIT) {
+        throw EvalError(psc::fmt::vformat(
+                _("Too many terms {}")
+                , psc::fmt::make_format_args(terms)));
+    }
+    if (terms < 1.0) {
+        return m_product ? 1.0 : 0.0;
+    }
+    const auto count = static_cast<size_t>(terms);
+    const size_t chunks = (count + CHUNK - 1) / CHUNK;
+    const size_t workers = std::min(chunks, static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)));
+    std::vector<Partial> partials(chunks, Partial{m_product ? 1.0 : 0.0});
+    auto work = [this, &partials, params, first, count, chunks, workers] (size_t worker, EvalFrame& with) {
+        for (size_t chunk = worker; chunk < chunks; chunk += workers) {
+            size_t start = chunk * CHUNK;
+            partials[chunk] = reduce(first + static_cast<double>(start), std::min(CHUNK, count - start), params, with);
+        }
+    };
+    std::vector<std::future<void>> tasks;
+    for (size_t worker = 1; worker < workers; ++worker) {
+        tasks.push_back(std::async(std::launch::async,
+            [work, worker, copy = frame.copy_detached()] {
+                work(worker, *copy);
+            }));
+    }
+    work(0, frame);
+    for (auto& task : tasks) {
+        task.get();     // rethrows e.g. a EvalError
+    }
+    Partial total{m_product ? 1.0 : 0.0};
+    for (auto& partial : partials) {
+        total.combine(partial, m_product);
+    }
+    return total.result(m_product);
+}
+
+FormSeries::Partial
+FormSeries::reduce(double first, size_t count, std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<double> index(std::min(BLOCK, count));
+    std::vector<double> terms(index.size());
+    Partial partial{m_product ? 1.0 : 0.0};
+    for (size_t done = 0; done < count; done += BLOCK) {
+        size_t len = std::min(BLOCK, count - done);
+        for (size_t i = 0; i < len; ++i) {
+            index[i] = first + static_cast<double>(done + i);
+        }
+        auto block = std::span<double>(terms).first(len);
+        frame.eval_batch(*m_body, std::span<const double>(index).first(len), block, params);
+        if (m_product) {
+            // a product of up to 64 mantissas from [0.5, 1) stays in range
+            for (size_t start = 0; start < len; start += 64) {
+                double mantissas = 1.0;
+                int64_t exponents = 0;
+                for (double factor : block.subspan(start, std::min(len - start, size_t{64}))) {
+                    int exp;
+                    mantissas *= std::frexp(factor, &exp);
+                    exponents += exp;
+                }
+                partial.multiply(mantissas, exponents);
+            }
+        }
+        else {
+            partial.add(VectorMath::sum(block));
+        }
+    }
+    return partial;
+}
+
+void
+FormSeries::Partial::add(double term)
+{
+    double sum = value + term;
+    if (std::abs(value) >= std::abs(term)) {
+        compensation += (value - sum) + term;
+    }
+    else {
+        compensation += (term - sum) + value;
+    }
+    value = sum;
+}
+
+// the value is kept within [0.5, 1)
+void
+FormSeries::Partial::multiply(double factor, int64_t exp)
+{
+    int norm;
+    value = std::frexp(value * factor, &norm);
+    exponent += exp + norm;
+}
+
+void
+FormSeries::Partial::combine(const Partial& other, bool product)
+{
+    if (product) {
+        multiply(other.value, other.exponent);
+    }
+    else {
+        add(other.value);
+        compensation += other.compensation;
+    }
+}
+
+double
+FormSeries::Partial::result(bool product) const
+{
+    if (product) {
+        auto exp = static_cast<int>(std::clamp(exponent, int64_t{-100000}, int64_t{100000}));
+        return std::ldexp(value, exp);
+    }
+    if (!std::isfinite(value)) {
+        return value;       // the compensation would be nan
+    }
+    return value + compensation;
+}
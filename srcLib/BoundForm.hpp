@@ -0,0 +1,202 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <glibmm.h>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Program.hpp"
+#include "Interval.hpp"
+#include "Dual.hpp"
+
+class EvalFrame;
+
+/*
+ * a construct with a bound variable, that evaluates a body
+ *   expression over a range e.g. solve(x^2 - 2; x; 0; 2).
+ *   The body is compiled with the bound variable as first
+ *   parameter, followed by the parameters of the enclosing
+ *   program, so it reads neither writes global variables.
+ *   The bounds of the range are the operands on the stack.
+ */
+class BoundForm
+{
+public:
+    explicit BoundForm(const PtrProgram& body);
+    explicit BoundForm(const BoundForm& orig) = delete;
+    virtual ~BoundForm() = default;
+
+    // params are those of the enclosing program
+    virtual double eval(double from, double to, std::span<const double> params, EvalFrame& frame) = 0;
+    // the default is exact just for points, otherwise unbounded
+    virtual Interval eval_interval(const Interval& from, const Interval& to
+                                 , std::span<const Interval> params, EvalFrame& frame);
+    // the default uses a central difference along the derivatives
+    virtual Dual eval_dual(const Dual& from, const Dual& to
+                         , std::span<const Dual> params, EvalFrame& frame);
+    const PtrProgram& get_body() const;
+
+    // the names that are parsed as form, with the arguments
+    //   (body; variable; from; to)
+    static bool is_form(const Glib::ustring& name);
+    // nullptr if there is no form by name
+    static std::shared_ptr<BoundForm> create(const Glib::ustring& name, const PtrProgram& body);
+    static constexpr size_t ARGUMENTS{4};
+protected:
+    // the parameters for the body with the variable at
+    std::vector<double> bind(double at, std::span<const double> params) const;
+
+    PtrProgram m_body;
+};
+
+/*
+ * the roots of the body within [from, to],
+ *   ranges the interval enclosure proves to be free of roots
+ *   are skipped, others are split while the enclosure is bounded,
+ *   until a sign change brackets a root, that is found by Newton steps with the
+ *   derivative from dual numbers, falling back to bisection
+ *   when a step leaves the bracket or converges slowly.
+ *   A root without sign change (even multiplicity) is found
+ *   by Newton steps from the finest ranges.
+ */
+class FormSolve : public BoundForm
+{
+public:
+    explicit FormSolve(const PtrProgram& body);
+
+    // the smallest root, throws if there is none
+    double eval(double from, double to, std::span<const double> params, EvalFrame& frame) override;
+    // ascending, at most limit
+    std::vector<double> roots(double from, double to, std::span<const double> params
+                            , EvalFrame& frame, size_t limit = ROOT_LIMIT);
+
+    // the range is scanned by this many segments
+    static constexpr size_t SCAN_SEGMENTS{64};
+    // segments that may contain a root without sign change are halved at most this often
+    static constexpr int SPLIT_LEVELS{12};
+    static constexpr int ITERATION_LIMIT{100};
+    static constexpr size_t ROOT_LIMIT{1000};
+    // a Newton iterate without sign change is taken as root
+    //   if it is this small relative to the values seen on scan
+    static constexpr double TOUCH_TOLERANCE{1.0e-12};
+private:
+    struct Segment
+    {
+        double lo;
+        double hi;
+        double flo;
+        double fhi;
+        int level;
+    };
+    double value(double at, std::span<const double> params, EvalFrame& frame);
+    Dual derivative(double at, std::span<const double> params, EvalFrame& frame);
+    Interval enclose(const Segment& segment, std::span<const double> params, EvalFrame& frame);
+    double bracketed(const Segment& segment, std::span<const double> params, EvalFrame& frame);
+    bool touching(const Segment& segment, double scale, std::span<const double> params
+                , EvalFrame& frame, double* root);
+};
+
+/*
+ * the integral of the body over [from, to] by adaptive
+ *   Gauss-Kronrod quadrature (G7, K15), the parts that exceed
+ *   their share of the tolerance are halved level by level,
+ *   the nodes of a level are evaluated by batch, large levels
+ *   in parallel chunks. Infinite bounds are mapped to a finite
+ *   range by substitution. The refinement ends with the estimated
+ *   error within the tolerance, or at the integration limit
+ *   of the frame that gives the count of parts.
+ */
+class FormIntegrate : public BoundForm
+{
+public:
+    explicit FormIntegrate(const PtrProgram& body);
+
+    double eval(double from, double to, std::span<const double> params, EvalFrame& frame) override;
+
+    static constexpr double REL_TOLERANCE{1.0e-10};
+    // the accepted error relative to the integral of |f|, as multiple of epsilon
+    static constexpr double ROUNDING_TOLERANCE{50.0};
+    // nodes evaluated by one task, fewer are done on the calling thread
+    static constexpr size_t CHUNK_MIN{4096};
+    static constexpr size_t NODES{15};
+private:
+    struct Part
+    {
+        double lo;
+        double hi;
+        double sum{};
+        double error{};
+        double abs{};       // integral of |f|
+    };
+    // the substitution x(t) if a bound is infinite
+    struct Range
+    {
+        double from;
+        double to;
+
+        double start() const;
+        double end() const;
+        double map(double t, double* jacobian) const;
+    };
+    void evaluate(std::span<Part> parts, const Range& range
+                , std::span<const double> params, EvalFrame& frame);
+    void evaluate_nodes(std::span<const double> x, std::span<double> y
+                      , std::span<const double> params, EvalFrame& frame);
+};
+
+/*
+ * the sum or product of the body for the integral indexes
+ *   within [from, to], the indexes are evaluated by batch
+ *   in blocks, large ranges by chunks in parallel.
+ *   Blocks are summed pairwise, the block and chunk results
+ *   are accumulated with compensation (Neumaier), products keep
+ *   a separate exponent, so partial products neither overflow
+ *   nor underflow. Chunks are combined in index order,
+ *   so the result does not depend on the count of threads.
+ */
+class FormSeries : public BoundForm
+{
+public:
+    FormSeries(const PtrProgram& body, bool product);
+
+    double eval(double from, double to, std::span<const double> params, EvalFrame& frame) override;
+
+    // indexes evaluated by one batch call
+    static constexpr size_t BLOCK{4096};
+    // indexes reduced by one task
+    static constexpr size_t CHUNK{size_t{1} << 20};
+    // larger ranges are refused, as they would take forever
+    static constexpr double TERM_LIMIT{1.0e12};
+private:
+    struct Partial
+    {
+        double value;           // sum, or product mantissa
+        double compensation{};  // sum: the lost low order part
+        int64_t exponent{};     // product: value * 2^exponent
+
+        void add(double term);
+        void multiply(double factor, int64_t exp);
+        void combine(const Partial& other, bool product);
+        double result(bool product) const;
+    };
+    Partial reduce(double first, size_t count, std::span<const double> params, EvalFrame& frame);
+
+    bool m_product;
+};
@@ -0,0 +1,106 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "Dual.hpp"
+#include "Program.hpp"
+
+Dual::Dual(double value)
+: val{value}
+{
+}
+
+Dual::Dual(double value, double derivative)
+: val{value}
+, der{derivative}
+{
+}
+
+Dual
+Dual::chain(const Dual& arg, double value, double derivative)
+{
+    // a constant argument stays constant, even where derivative is not finite
+    return Dual(value, arg.der == 0.0 ? 0.0 : derivative * arg.der);
+}
+
+Dual
+Dual::neg(const Dual& val)
+{
+    return Dual(-val.val, -val.der);
+}
+
+Dual
+Dual::add(const Dual& left, const Dual& right)
+{
+    return Dual(left.val + right.val, left.der + right.der);
+}
+
+Dual
+Dual::sub(const Dual& left, const Dual& right)
+{
+    return Dual(left.val - right.val, left.der - right.der);
+}
+
+Dual
+Dual::mul(const Dual& left, const Dual& right)
+{
+    return Dual(left.val * right.val, left.der * right.val + left.val * right.der);
+}
+
+Dual
+Dual::div(const Dual& left, const Dual& right)
+{
+    double quot = left.val / right.val;
+    return Dual(quot, (left.der - quot * right.der) / right.val);
+}
+
+// fmod(l, r) = l - trunc(l / r) * r, with the quotient constant between the steps
+Dual
+Dual::mod(const Dual& left, const Dual& right)
+{
+    return Dual(std::fmod(left.val, right.val)
+              , left.der - std::trunc(left.val / right.val) * right.der);
+}
+
+// d/dx b^e = e * b^(e - 1) * b' + b^e * ln(b) * e'
+Dual
+Dual::pow(const Dual& base, const Dual& exponent)
+{
+    double val = std::pow(base.val, exponent.val);
+    double der = 0.0;
+    if (base.der != 0.0) {
+        der = exponent.val * std::pow(base.val, exponent.val - 1.0) * base.der;
+    }
+    if (exponent.der != 0.0) {      // just then the log is needed, e.g. x^2 works for a negative x
+        der += val * std::log(base.val) * exponent.der;
+    }
+    return Dual(val, der);
+}
+
+// as Program::powi for the integral exponent of OpCode::PowI
+Dual
+Dual::powi(const Dual& base, double exponent)
+{
+    double val = Program::powi(base.val, exponent);
+    if (base.der == 0.0
+     || exponent == 0.0) {
+        return Dual(val);
+    }
+    return Dual(val, exponent * Program::powi(base.val, exponent - 1.0) * base.der);
+}
@@ -0,0 +1,46 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * a value with its derivative by one parameter,
+ *   evaluating with these gives f(x) and f'(x)
+ *   in one pass (forward mode differentiation).
+ */
+struct Dual
+{
+    double val{};
+    double der{};
+
+    Dual() = default;
+    explicit Dual(double value);        // a constant
+    Dual(double value, double derivative);
+
+    // apply a function with the value and derivative at arg.val
+    static Dual chain(const Dual& arg, double value, double derivative);
+
+    static Dual neg(const Dual& val);
+    static Dual add(const Dual& left, const Dual& right);
+    static Dual sub(const Dual& left, const Dual& right);
+    static Dual mul(const Dual& left, const Dual& right);
+    static Dual div(const Dual& left, const Dual& right);
+    static Dual mod(const Dual& left, const Dual& right);
+    static Dual pow(const Dual& base, const Dual& exponent);
+    static Dual powi(const Dual& base, double exponent);
+};
@@ -0,0 +1,653 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
+#include <psc_format.hpp>
+#include <psc_i18n.hpp>
+
+#include "EvalFrame.hpp"
+#include "BaseEval.hpp"
+#include "BoundForm.hpp"
+#include "ListReduction.hpp"
+#include "VectorMath.hpp"
+
+namespace {
+
+// helpers for batch evaluation, restrict tells the compiler
+//   that left and right are different rows of the stack
+template <typename Op>
+inline void
+apply_block(double* __restrict left, const double* __restrict right, size_t len, Op op)
+{
+    for (size_t i = 0; i < len; ++i) {
+        left[i] = op(left[i], right[i]);
+    }
+}
+
+inline void
+fill_block(double* __restrict row, double value, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        row[i] = value;
+    }
+}
+
+// as Program::powi with the loop over the exponent bits outside
+inline void
+powi_block(double* __restrict row, double* __restrict base, double exponent, size_t len)
+{
+    std::copy_n(row, len, base);
+    fill_block(row, 1.0, len);
+    for (auto n = static_cast<uint32_t>(std::abs(exponent)); n > 0; n >>= 1) {
+        if (n & 1u) {
+            apply_block(row, base, len, [] (double l, double r) { return l * r; });
+        }
+        for (size_t i = 0; i < len; ++i) {
+            base[i] *= base[i];
+        }
+    }
+    if (exponent < 0.0) {
+        for (size_t i = 0; i < len; ++i) {
+            row[i] = 1.0 / row[i];
+        }
+    }
+}
+
+Interval
+apply_interval(OpCode code, const Interval& left, const Interval& right)
+{
+    switch (code) {
+    case OpCode::Add:
+        return Interval::add(left, right);
+    case OpCode::Sub:
+        return Interval::sub(left, right);
+    case OpCode::Mul:
+        return Interval::mul(left, right);
+    case OpCode::Div:
+        return Interval::div(left, right);
+    case OpCode::Mod:
+        return Interval::mod(left, right);
+    case OpCode::Pow:
+        return Interval::pow(left, right);
+    default:            // the bit operations are just exact for points
+        if (left.is_empty()
+         || right.is_empty()) {
+            return Interval::empty();
+        }
+        if (left.is_point()
+         && right.is_point()) {
+            return Interval(Program::apply(code, left.lo, right.lo));
+        }
+        return Interval::entire();
+    }
+}
+
+Dual
+apply_dual(OpCode code, const Dual& left, const Dual& right)
+{
+    switch (code) {
+    case OpCode::Add:
+        return Dual::add(left, right);
+    case OpCode::Sub:
+        return Dual::sub(left, right);
+    case OpCode::Mul:
+        return Dual::mul(left, right);
+    case OpCode::Div:
+        return Dual::div(left, right);
+    case OpCode::Mod:
+        return Dual::mod(left, right);
+    case OpCode::Pow:
+        return Dual::pow(left, right);
+    default:            // the bit operations are piecewise constant
+        return Dual(Program::apply(code, left.val, right.val));
+    }
+}
+
+}
+
+EvalFrame::EvalFrame(BaseEval& context)
+: EvalFrame(&context.get_variables(), context.get_right_angle(), context.get_integration_limit())
+{
+}
+
+EvalFrame::EvalFrame(const VariableStore* variables, double rightAngle, size_t integrationLimit)
+: m_variables{variables}
+, m_rightAngle{rightAngle}
+, m_radian{m_rightAngle == VectorMath::RIGHT_ANGLE}
+, m_integrationLimit{integrationLimit}
+{
+}
+
+void
+EvalFrame::detach()
+{
+    if (!m_copy) {
+        m_copy = std::make_unique<VariableStore>();
+        m_copy->assign(*m_variables);
+        m_variables = m_copy.get();
+    }
+}
+
+std::unique_ptr<EvalFrame>
+EvalFrame::copy_detached() const
+{
+    std::unique_ptr<EvalFrame> copy(new EvalFrame(m_variables, m_rightAngle, m_integrationLimit));
+    copy->m_locals = m_locals;
+    copy->m_localDefined = m_localDefined;
+    copy->detach();
+    return copy;
+}
+
+void
+EvalFrame::set_local(size_t slot, double val)
+{
+    if (slot >= m_locals.size()) {
+        m_locals.resize(slot + 1);
+        m_localDefined.resize(slot + 1, 0);
+    }
+    m_locals[slot] = val;
+    m_localDefined[slot] = 1;
+}
+
+bool
+EvalFrame::is_defined(size_t slot) const
+{
+    return (slot < m_localDefined.size() && m_localDefined[slot])
+        || (slot < m_variables->size() && m_variables->is_defined(slot));
+}
+
+double
+EvalFrame::get(size_t slot) const
+{
+    if (slot < m_localDefined.size()
+     && m_localDefined[slot]) {
+        return m_locals[slot];
+    }
+    return m_variables->get(slot);
+}
+
+std::span<const double>
+EvalFrame::get_list(size_t slot) const
+{
+    if (!m_variables->is_list(slot)) {
+        auto& name = m_variables->get_name(slot);
+        throw EvalError(psc::fmt::vformat(
+                _("The variable {} is no list")
+                , psc::fmt::make_format_args(name)));
+    }
+    return m_variables->get_list(slot);
+}
+
+void
+EvalFrame::undefined(size_t slot) const
+{
+    Glib::ustring name;
+    if (slot < m_variables->size()) {
+        name = m_variables->get_name(slot);
+        if (m_variables->is_list(slot)) {
+            throw EvalError(psc::fmt::vformat(
+                    _("The list {} has to be reduced e.g. by sum")
+                    , psc::fmt::make_format_args(name)));
+        }
+    }
+    throw EvalError(psc::fmt::vformat(
+            _("No variable named {}")
+            , psc::fmt::make_format_args(name)));
+}
+
+// RIGHT_ANGLE is exactly half of π, so e.g. for degree
+//   the results equal in * π / 180 as used by AngleConversion
+double
+EvalFrame::toRadian(double val) const
+{
+    return m_radian ? val : val * VectorMath::RIGHT_ANGLE / m_rightAngle;
+}
+
+// as the factor and the product are rounded,
+//   each bound may be off by about 1.5 ulp
+Interval
+EvalFrame::toRadian(const Interval& val) const
+{
+    if (m_radian
+     || val.is_empty()) {
+        return val;
+    }
+    return Interval::outward(toRadian(val.lo), toRadian(val.hi), 2);
+}
+
+double
+EvalFrame::fromRadian(double val) const
+{
+    return m_radian ? val : val * m_rightAngle / VectorMath::RIGHT_ANGLE;
+}
+
+double
+EvalFrame::get_right_angle() const
+{
+    return m_rightAngle;
+}
+
+size_t
+EvalFrame::get_integration_limit() const
+{
+    return m_integrationLimit;
+}
+
+double
+EvalFrame::eval(const Program& program, std::span<const double> params)
+{
+    if (params.size() < program.get_param_count()) {
+        auto count = program.get_param_count();
+        throw EvalError(psc::fmt::vformat(
+                _("Expecting {} parameters")
+                , psc::fmt::make_format_args(count)));
+    }
+    std::array<double, LOCAL_STACK> local;
+    std::vector<double> heap;
+    double* values = local.data();
+    if (program.get_max_depth() > LOCAL_STACK) {
+        heap.resize(program.get_max_depth());
+        values = heap.data();
+    }
+    size_t sp = 0;      // consistency was checked by compile, so no checks for under/overrun
+    for (auto& instr : program.get_code()) {
+        switch (instr.code) {
+        case OpCode::Const:
+            values[sp++] = instr.value;
+            break;
+        case OpCode::Load:
+            if (!is_defined(instr.index)) {
+                undefined(instr.index);
+            }
+            values[sp++] = get(instr.index);
+            break;
+        case OpCode::Param:
+            values[sp++] = params[instr.index];
+            break;
+        case OpCode::Call:
+            values[sp - 1] = instr.function->eval(values[sp - 1], this);
+            break;
+        case OpCode::CallN:
+            sp -= instr.index - 1;
+            values[sp - 1] = instr.function->eval_args(std::span<const double>(values + sp - 1, instr.index), this);
+            break;
+        case OpCode::Neg:
+            values[sp - 1] = -values[sp - 1];
+            break;
+        case OpCode::Dup:
+            values[sp] = values[sp - 1];
+            ++sp;
+            break;
+        case OpCode::PowI:
+            values[sp - 1] = Program::powi(values[sp - 1], instr.value);
+            break;
+        case OpCode::Form:
+            --sp;
+            values[sp - 1] = instr.form->eval(values[sp - 1], values[sp]
+                                            , params.first(program.get_param_count()), *this);
+            break;
+        case OpCode::Reduce:
+            values[sp++] = instr.reduction->eval(params.first(program.get_param_count()), *this);
+            break;
+        default:
+            --sp;
+            values[sp - 1] = Program::apply(instr.code, values[sp - 1], values[sp]);
+            break;
+        }
+    }
+	double total = values[0];
+	if (program.is_assign()) {
+        set_local(program.get_assign(), total);
+	}
+	return total;
+}
+
+// each input value is bound as the first parameter,
+//   instructions are processed for a block of values at once,
+//   so the dispatch is paid once per block not per value.
+void
+EvalFrame::eval_batch(const Program& program, std::span<const double> input, std::span<double> output
+                    , std::span<const double> params)
+{
+    if (output.size() < input.size()) {
+        throw EvalError(_("Batch output is smaller than input"));
+    }
+    std::vector<std::span<const double>> rows{input};
+    for (auto& param : params) {
+        rows.emplace_back(&param, 1);
+    }
+    eval_rows(program, rows, output.first(input.size()));
+}
+
+void
+EvalFrame::eval_rows(const Program& program, std::span<const std::span<const double>> rows
+                   , std::span<double> output)
+{
+    if (program.get_param_count() > rows.size()) {
+        auto count = program.get_param_count();
+        throw EvalError(psc::fmt::vformat(
+                _("Expecting {} parameters")
+                , psc::fmt::make_format_args(count)));
+    }
+    if (program.is_assign()) {
+        throw EvalError(_("No assignment for batch evaluation"));
+    }
+    for (auto& instr : program.get_code()) {    // variables won't change during batch so check once
+        if (instr.code == OpCode::Load
+         && !is_defined(instr.index)) {
+            undefined(instr.index);
+        }
+    }
+    constexpr auto len = BATCH_BLOCK;
+    std::vector<double> nested;         // a form evaluated by batch within batch
+    auto& stack = m_batching ? nested : m_rows;
+    stack.resize(std::max(stack.size(), (program.get_max_depth() + 1) * len));
+    double* stackRows = stack.data();
+    struct Restore          // also on exception
+    {
+        bool& flag;
+        bool value;
+        ~Restore() { flag = value; }
+    } restore{m_batching, m_batching};
+    m_batching = true;
+    double* scratch = stackRows + program.get_max_depth() * len;   // last row is not used by the stack
+    std::vector<double> bound(program.get_param_count());
+    auto bind = [&] (size_t at) {       // the parameters of one value e.g. for a form
+        for (size_t param = 0; param < bound.size(); ++param) {
+            bound[param] = rows[param].size() == 1 ? rows[param][0] : rows[param][at];
+        }
+    };
+    // a reduction that is the same for all values is done once
+    std::vector<std::pair<const ListReduction*, double>> reduced;
+    for (size_t start = 0; start < output.size(); start += len) {
+        const size_t count = std::min(len, output.size() - start);
+        size_t sp = 0;      // as on scalar evaluation, but each stack entry is a row
+        for (auto& instr : program.get_code()) {
+            double* top = stackRows + sp * len;   // next free row
+            double* right = sp > 0 ? top - len : top;   // unary: operand
+            double* left = right;                       // binary: left and right operand
+            if (instr.code == OpCode::CallN) {
+                sp -= instr.index - 1;
+                left = stackRows + (sp - 1) * len;     // the first argument
+            }
+            else if (Program::stack_effect(instr) < 0) {
+                --sp;
+                left = stackRows + (sp - 1) * len;
+            }
+            switch (instr.code) {
+            case OpCode::Const:
+                fill_block(top, instr.value, len);
+                ++sp;
+                break;
+            case OpCode::Load:
+                fill_block(top, get(instr.index), len);
+                ++sp;
+                break;
+            case OpCode::Param: {
+                auto row = rows[instr.index];
+                if (row.size() == 1) {      // the same for all
+                    fill_block(top, row[0], len);
+                }
+                else {
+                    std::copy_n(row.begin() + static_cast<std::ptrdiff_t>(start), count, top);
+                    fill_block(top + count, row[start + count - 1], len - count);    // pad last block
+                }
+                ++sp;
+                break;
+            }
+            case OpCode::Call:
+                instr.function->eval_batch(std::span<const double>(right, count)
+                                         , std::span<double>(right, count), this);
+                break;
+            case OpCode::CallN:     // the arguments are rows
+                instr.function->eval_batch_args(std::span<const double>(left, instr.index * len), len
+                                              , std::span<double>(left, count), this);
+                break;
+            case OpCode::Neg:
+                for (size_t i = 0; i < len; ++i) {
+                    right[i] = -right[i];
+                }
+                break;
+            case OpCode::Dup:
+                std::copy_n(right, len, top);
+                ++sp;
+                break;
+            case OpCode::PowI:
+                powi_block(right, scratch, instr.value, len);
+                break;
+            case OpCode::Form:
+                for (size_t i = 0; i < count; ++i) {
+                    bind(start + i);
+                    left[i] = instr.form->eval(left[i], right[i], bound, *this);
+                }
+                break;
+            case OpCode::Reduce:
+                bind(start);
+                if (instr.reduction->uses_params()) {
+                    for (size_t i = 0; i < count; ++i) {
+                        bind(start + i);
+                        top[i] = instr.reduction->eval(bound, *this);
+                    }
+                }
+                else {
+                    auto same = std::find_if(reduced.begin(), reduced.end()
+                            , [&instr] (const std::pair<const ListReduction*, double>& entry) {
+                                return entry.first == instr.reduction;
+                            });
+                    if (same == reduced.end()) {
+                        reduced.emplace_back(instr.reduction, instr.reduction->eval(bound, *this));
+                        same = reduced.end() - 1;
+                    }
+                    fill_block(top, same->second, len);
+                }
+                ++sp;
+                break;
+            case OpCode::Add:
+                apply_block(left, right, len, [] (double l, double r) { return l + r; });
+                break;
+            case OpCode::Sub:
+                apply_block(left, right, len, [] (double l, double r) { return l - r; });
+                break;
+            case OpCode::Mul:
+                apply_block(left, right, len, [] (double l, double r) { return l * r; });
+                break;
+            case OpCode::Div:
+                apply_block(left, right, len, [] (double l, double r) { return l / r; });
+                break;
+            case OpCode::Mod:
+                apply_block(left, right, count, [] (double l, double r) { return std::fmod(l, r); });
+                break;
+            case OpCode::Pow:
+                apply_block(left, right, count, [] (double l, double r) { return std::pow(l, r); });
+                break;
+            case OpCode::Shl:
+                apply_block(left, right, count, [] (double l, double r) {
+                    return static_cast<double>(static_cast<uint64_t>(l) << static_cast<uint64_t>(r)); });
+                break;
+            case OpCode::Shr:
+                apply_block(left, right, count, [] (double l, double r) {
+                    return static_cast<double>(static_cast<uint64_t>(l) >> static_cast<uint64_t>(r)); });
+                break;
+            case OpCode::And:
+                apply_block(left, right, count, [] (double l, double r) {
+                    return static_cast<double>(static_cast<uint64_t>(l) & static_cast<uint64_t>(r)); });
+                break;
+            case OpCode::Or:
+                apply_block(left, right, count, [] (double l, double r) {
+                    return static_cast<double>(static_cast<uint64_t>(l) | static_cast<uint64_t>(r)); });
+                break;
+            }
+        }
+        std::copy_n(stackRows, count, output.begin() + static_cast<std::ptrdiff_t>(start));
+    }
+}
+
+// as eval, with each stack entry a interval
+Interval
+EvalFrame::eval_interval(const Program& program, std::span<const Interval> params)
+{
+    if (params.size() < program.get_param_count()) {
+        auto count = program.get_param_count();
+        throw EvalError(psc::fmt::vformat(
+                _("Expecting {} parameters")
+                , psc::fmt::make_format_args(count)));
+    }
+    std::array<Interval, LOCAL_STACK> local;
+    std::vector<Interval> heap;
+    Interval* values = local.data();
+    if (program.get_max_depth() > LOCAL_STACK) {
+        heap.resize(program.get_max_depth());
+        values = heap.data();
+    }
+    auto& code = program.get_code();
+    auto is_next = [&code] (size_t pc, std::initializer_list<OpCode> ops) {
+        return pc + ops.size() < code.size()
+            && std::equal(ops.begin(), ops.end(), code.begin() + static_cast<std::ptrdiff_t>(pc + 1),
+                          [] (OpCode op, const Instruction& instr) { return instr.code == op; });
+    };
+    size_t sp = 0;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        auto& instr = code[pc];
+        switch (instr.code) {
+        case OpCode::Const:
+            values[sp++] = Interval(instr.value);
+            break;
+        case OpCode::Load:
+            if (!is_defined(instr.index)) {
+                undefined(instr.index);
+            }
+            values[sp++] = Interval(get(instr.index));
+            break;
+        case OpCode::Param:
+            values[sp++] = params[instr.index];
+            break;
+        case OpCode::Call:
+            values[sp - 1] = instr.function->eval_interval(values[sp - 1], this);
+            break;
+        case OpCode::CallN:
+            sp -= instr.index - 1;
+            values[sp - 1] = instr.function->eval_interval_args(std::span<const Interval>(values + sp - 1, instr.index), this);
+            break;
+        case OpCode::Neg:
+            values[sp - 1] = Interval::neg(values[sp - 1]);
+            break;
+        case OpCode::Dup:
+            // the Optimizer emits small powers with Dup, as a product
+            //   of the same value these would give a wider enclosure
+            if (is_next(pc, {OpCode::Dup, OpCode::Mul, OpCode::Mul})) {
+                values[sp - 1] = Interval::powi(values[sp - 1], 3.0);
+                pc += 3;
+            }
+            else if (is_next(pc, {OpCode::Mul})) {
+                values[sp - 1] = Interval::powi(values[sp - 1], 2.0);
+                pc += 1;
+            }
+            else {
+                values[sp] = values[sp - 1];
+                ++sp;
+            }
+            break;
+        case OpCode::PowI:
+            values[sp - 1] = Interval::powi(values[sp - 1], instr.value);
+            break;
+        case OpCode::Form:
+            --sp;
+            values[sp - 1] = instr.form->eval_interval(values[sp - 1], values[sp]
+                                                     , params.first(program.get_param_count()), *this);
+            break;
+        case OpCode::Reduce:
+            values[sp++] = instr.reduction->eval_interval(params.first(program.get_param_count()), *this);
+            break;
+        default:
+            --sp;
+            values[sp - 1] = apply_interval(instr.code, values[sp - 1], values[sp]);
+            break;
+        }
+    }
+    return values[0];
+}
+
+// as eval, with each stack entry a value and derivative
+Dual
+EvalFrame::eval_dual(const Program& program, std::span<const Dual> params)
+{
+    if (params.size() < program.get_param_count()) {
+        auto count = program.get_param_count();
+        throw EvalError(psc::fmt::vformat(
+                _("Expecting {} parameters")
+                , psc::fmt::make_format_args(count)));
+    }
+    std::array<Dual, LOCAL_STACK> local;
+    std::vector<Dual> heap;
+    Dual* values = local.data();
+    if (program.get_max_depth() > LOCAL_STACK) {
+        heap.resize(program.get_max_depth());
+        values = heap.data();
+    }
+    size_t sp = 0;
+    for (auto& instr : program.get_code()) {
+        switch (instr.code) {
+        case OpCode::Const:
+            values[sp++] = Dual(instr.value);
+            break;
+        case OpCode::Load:
+            if (!is_defined(instr.index)) {
+                undefined(instr.index);
+            }
+            values[sp++] = Dual(get(instr.index));
+            break;
+        case OpCode::Param:
+            values[sp++] = params[instr.index];
+            break;
+        case OpCode::Call:
+            values[sp - 1] = instr.function->eval_dual(values[sp - 1], this);
+            break;
+        case OpCode::CallN:
+            sp -= instr.index - 1;
+            values[sp - 1] = instr.function->eval_dual_args(std::span<const Dual>(values + sp - 1, instr.index), this);
+            break;
+        case OpCode::Neg:
+            values[sp - 1] = Dual::neg(values[sp - 1]);
+            break;
+        case OpCode::Dup:
+            values[sp] = values[sp - 1];
+            ++sp;
+            break;
+        case OpCode::PowI:
+            values[sp - 1] = Dual::powi(values[sp - 1], instr.value);
+            break;
+        case OpCode::Form:
+            --sp;
+            values[sp - 1] = instr.form->eval_dual(values[sp - 1], values[sp]
+                                                 , params.first(program.get_param_count()), *this);
+            break;
+        case OpCode::Reduce:
+            values[sp++] = instr.reduction->eval_dual(params.first(program.get_param_count()), *this);
+            break;
+        default:
+            --sp;
+            values[sp - 1] = apply_dual(instr.code, values[sp - 1], values[sp]);
+            break;
+        }
+    }
+    return values[0];
+}
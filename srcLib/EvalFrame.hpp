@@ -0,0 +1,105 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include "Program.hpp"
+#include "VariableStore.hpp"
+#include "Interval.hpp"
+#include "Dual.hpp"
+
+class BaseEval;
+
+/*
+ * the mutable state of evaluating compiled programs:
+ *   the stack, local bindings and a read-only view of
+ *   the variables of the compiling BaseEval.
+ *   Programs are not changed by evaluation, so each thread
+ *   may evaluate the same program with its own frame.
+ *   Create frames on the thread that owns the BaseEval,
+ *   and detach them if the variables may change while
+ *   the frame is used on a other thread.
+ */
+class EvalFrame
+{
+public:
+    explicit EvalFrame(BaseEval& context);
+    explicit EvalFrame(const EvalFrame& orig) = delete;
+    virtual ~EvalFrame() = default;
+
+    // take a copy of the variables, so the frame no longer refers to the context
+    void detach();
+    // a detached frame with the same locals and settings, e.g. to evaluate
+    //   on a other thread, call on the thread that uses this frame
+    std::unique_ptr<EvalFrame> copy_detached() const;
+    // a assignment is kept as local binding of the frame
+    double eval(const Program& program, std::span<const double> params = {});
+    // evaluate program for each input value as the first parameter,
+    //   followed by params that are the same for all
+    void eval_batch(const Program& program, std::span<const double> input, std::span<double> output
+                  , std::span<const double> params = {});
+    // evaluate program for each output value, a row for each parameter,
+    //   a row of a single value is the same for all
+    void eval_rows(const Program& program, std::span<const std::span<const double>> rows
+                 , std::span<double> output);
+    // enclosure of the results for all parameters within params,
+    //   e.g. to skip ranges of x that can't reach a value
+    Interval eval_interval(const Program& program, std::span<const Interval> params);
+    // value and derivative, by the parameters with a non zero der e.g. Dual(x, 1.0)
+    Dual eval_dual(const Program& program, std::span<const Dual> params);
+
+    // locals hide the variables of the context
+    void set_local(size_t slot, double val);
+    bool is_defined(size_t slot) const;
+    double get(size_t slot) const;
+    // the list held by slot, the context must keep it while evaluating
+    std::span<const double> get_list(size_t slot) const;
+
+    // the angle unit is given by the size of a right angle
+    double toRadian(double val) const;
+    // the bounds are rounded outward, so the result encloses the exact angles
+    Interval toRadian(const Interval& val) const;
+    double fromRadian(double val) const;
+    double get_right_angle() const;
+    // subintervals used by integrate at most
+    size_t get_integration_limit() const;
+
+    // evaluation will use this without allocation
+    static constexpr size_t LOCAL_STACK{32};
+    // values processed by one instruction in batch evaluation,
+    //   a fixed size allows the compiler to vectorize the loops
+    static constexpr size_t BATCH_BLOCK{256};
+private:
+    EvalFrame(const VariableStore* variables, double rightAngle, size_t integrationLimit);
+    [[noreturn]] void undefined(size_t slot) const;
+
+    const VariableStore* m_variables;
+    std::unique_ptr<VariableStore> m_copy;      // if detached
+    std::vector<double> m_locals;
+    std::vector<uint8_t> m_localDefined;
+    double m_rightAngle;
+    bool m_radian;
+    size_t m_integrationLimit;
+    std::vector<double> m_rows;     // batch stack, kept for the next call
+    bool m_batching{false};         // m_rows in use e.g. by a form within batch evaluation
+};
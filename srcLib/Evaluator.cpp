@@ -0,0 +1,149 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "Evaluator.hpp"
+#include "Syntax.hpp"
+
+Evaluator::Evaluator()
+: BaseEval()
+, m_angleConv{RadianConversion::get_conversion("")} // use search with invalid key so we wont create addition references
+, m_outputFormat{OutformDecimal::get_form("")} // as above, avoid the hassle to correctly free it afterwards
+, m_functionMap{
+          {"sqrt",   std::make_shared<FunctionSqrt>()}
+    	, {"cbrt",   std::make_shared<FunctionCbrt>()}
+        , {"exp",    std::make_shared<FunctionExp>()}
+        , {"sin",    std::make_shared<FunctionSin>()}
+        , {"cos",    std::make_shared<FunctionCos>()}
+        , {"tan",    std::make_shared<FunctionTan>()}
+        , {"log2",   std::make_shared<FunctionLog2>()}
+        , {"abs",    std::make_shared<FunctionAbs>()}
+        , {"fac",    std::make_shared<FunctionFactorial>()}
+        , {"atan2",  std::make_shared<FunctionAtan2>()}
+        , {"hypot",  std::make_shared<FunctionHypot>()}
+        , {"min",    std::make_shared<FunctionMin>()}
+        , {"max",    std::make_shared<FunctionMax>()}
+        , {"pow",    std::make_shared<FunctionPow>()}
+        , {"fma",    std::make_shared<FunctionFma>()}
+        , {"clamp",  std::make_shared<FunctionClamp>()}
+        , {"logb",   std::make_shared<FunctionLogb>()}
+    }
+{
+    auto functLog = std::make_shared<FunctionLog>();
+    m_functionMap.insert(std::make_pair("log",    functLog));
+    m_functionMap.insert(std::make_pair("ln",     functLog));
+    auto functAsin = std::make_shared<FunctionAsin>();
+    m_functionMap.insert(std::make_pair("asin",   functAsin));
+    m_functionMap.insert(std::make_pair("arcsin", functAsin));
+    auto functAcos = std::make_shared<FunctionAcos>();
+    m_functionMap.insert(std::make_pair("acos",   functAcos));
+    m_functionMap.insert(std::make_pair("arccos", functAcos));
+    auto functAtan = std::make_shared<FunctionAtan>();
+    m_functionMap.insert(std::make_pair("atan",   functAtan));
+    m_functionMap.insert(std::make_pair("arctan", functAtan));
+    auto functLog10 = std::make_shared<FunctionLog10>();
+    m_functionMap.insert(std::make_pair("log10", functLog10));
+    m_functionMap.insert(std::make_pair("lg",    functLog10));
+
+    set_constant(Glib::ustring(1, 0x03c0), G_PI); // π or pi set some defaults
+    set_constant("e", G_E);
+    set_constant(Glib::ustring(1, 0x03d5), (1.0 + std::sqrt(5.0)) / 2.0); // ϕ or phi
+}
+
+double
+Evaluator::evaluate(const Glib::ustring& expr)
+{
+    // the syntax lives only for this call, so it may refer to us without owning
+    Syntax syntax(m_outputFormat, std::shared_ptr<BaseEval>(std::shared_ptr<BaseEval>(), this));
+    Glib::ustring text{expr};
+    return eval(syntax.parse(text));
+}
+
+std::shared_ptr<Function>
+Evaluator::getFunction(const Glib::ustring& name)
+{
+    auto& map = get_function_map();
+    auto iter = map.find(name);
+    if (iter != map.end()) {
+        return iter->second;
+    }
+    return std::shared_ptr<Function>();
+}
+
+const Evaluator::FunctionMap&
+Evaluator::get_function_map()
+{
+    return m_functionMap;
+}
+
+double
+Evaluator::get_right_angle()
+{
+    return m_angleConv->get_right_angle();
+}
+
+PtrAngleConversion
+Evaluator::get_angle_conv()
+{
+    return m_angleConv;
+}
+
+void
+Evaluator::set_angle_conv(const PtrAngleConversion& angleConv)
+{
+    m_angleConv = angleConv;
+}
+
+PtrOutputForm
+Evaluator::get_output_format()
+{
+    return m_outputFormat;
+}
+
+void
+Evaluator::set_output_format(const PtrOutputForm& outputFormat)
+{
+    m_outputFormat = outputFormat;
+}
+
+std::map<Glib::ustring, double>
+Evaluator::get_variable_map()
+{
+    std::map<Glib::ustring, double> variables;
+    for (size_t slot = 0; slot < m_variables.size(); ++slot) {
+        if (m_variables.is_defined(slot)
+         && !m_variables.is_constant(slot)) {
+            variables.insert(std::make_pair(m_variables.get_name(slot), m_variables.get(slot)));
+        }
+    }
+    return variables;
+}
+
+std::map<Glib::ustring, std::vector<double>>
+Evaluator::get_list_map()
+{
+    std::map<Glib::ustring, std::vector<double>> lists;
+    for (size_t slot = 0; slot < m_variables.size(); ++slot) {
+        if (m_variables.is_list(slot)) {
+            auto values = m_variables.get_list(slot);
+            lists.insert(std::make_pair(m_variables.get_name(slot), std::vector<double>(values.begin(), values.end())));
+        }
+    }
+    return lists;
+}
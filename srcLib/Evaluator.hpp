@@ -0,0 +1,70 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glibmm.h>
+#include <map>
+#include <vector>
+#include <memory>
+
+#include "BaseEval.hpp"
+#include "AngleUnit.hpp"
+#include "OutputForm.hpp"
+
+/*
+ * evaluation context without any gui dependency,
+ *   provides the builtin functions, constants
+ *   and the angle unit for the trigometric functions.
+ *   Use this to embed the evaluation e.g.:
+ *     Evaluator eval;
+ *     double val = eval.evaluate("sin(π/4)^2");
+ *   The gui extends this with a view of the variables.
+ */
+class Evaluator
+: public BaseEval
+{
+public:
+    Evaluator();
+    explicit Evaluator(const Evaluator& orig) = delete;
+    virtual ~Evaluator() = default;
+
+    // parse and evaluate a expression, assignments will set a variable
+    double evaluate(const Glib::ustring& expr);
+    std::shared_ptr<Function> getFunction(const Glib::ustring& name) override;
+    double get_right_angle() override;
+
+    PtrAngleConversion get_angle_conv();
+    void set_angle_conv(const PtrAngleConversion& angleConv);
+    // the format is used for parsing numbers as well
+    PtrOutputForm get_output_format();
+    void set_output_format(const PtrOutputForm& outputFormat);
+    // all variables, without constants
+    std::map<Glib::ustring, double> get_variable_map();
+    // all lists
+    std::map<Glib::ustring, std::vector<double>> get_list_map();
+
+protected:
+    using FunctionMap = std::map<Glib::ustring, std::shared_ptr<Function>>;
+    const FunctionMap& get_function_map();
+
+private:
+    PtrAngleConversion m_angleConv;
+    PtrOutputForm m_outputFormat;
+    FunctionMap m_functionMap;
+};
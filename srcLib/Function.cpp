@@ -18,92 +18,583 @@
 
 
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <numbers>
+#include <vector>
+#include <psc_format.hpp>
+#include <psc_i18n.hpp>
 
 #include "Function.hpp"
-#include "BaseEval.hpp"
+#include "EvalFrame.hpp"
+#include "Token.hpp"
+#include "VectorMath.hpp"
 
+namespace {
 
+Interval
+log_interval(const Interval& arg)
+{
+    if (arg.is_empty()
+     || arg.hi < 0.0) {
+        return Interval::empty();
+    }
+    return Interval::increasing(Interval(std::max(arg.lo, 0.0), arg.hi)
+                              , [] (double val) { return std::log(val); });
+}
+
+bool
+all_points(std::span<const Interval> args)
+{
+    return std::all_of(args.begin(), args.end(), [] (const Interval& arg) {
+        return arg.is_point();
+    });
+}
+
+}
+
+// a function with more arguments is called by eval_args only
 double
-FunctionSqrt::eval(double val, BaseEval *evalContext)
+Function::eval(double argument, EvalFrame* frame)
+{
+    auto arity = get_arity();
+    throw EvalError(psc::fmt::vformat(
+            _("The function expects {} arguments")
+            , psc::fmt::make_format_args(arity)));
+}
+
+void
+Function::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = eval(in[i], frame);
+    }
+}
+
+Interval
+Function::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()) {
+        return Interval::empty();
+    }
+    if (arg.is_point()) {
+        double val = eval(arg.lo, frame);
+        return std::isnan(val) ? Interval::empty() : Interval::outward(val, val, 2);
+    }
+    return Interval::entire();
+}
+
+// for functions without a known derivative
+Dual
+Function::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double val = eval(arg.val, frame);
+    if (arg.der == 0.0) {
+        return Dual(val);
+    }
+    double step = std::cbrt(std::numeric_limits<double>::epsilon()) * std::max(std::abs(arg.val), 1.0);
+    double der = (eval(arg.val + step, frame) - eval(arg.val - step, frame)) / (2.0 * step);
+    return Dual::chain(arg, val, der);
+}
+
+bool
+Function::depends_on_context()
+{
+    return false;
+}
+
+size_t
+Function::get_arity()
+{
+    return 1;
+}
+
+double
+Function::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return eval(args[0], frame);
+}
+
+Interval
+Function::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    if (args.size() == 1) {
+        return eval_interval(args[0], frame);
+    }
+    std::vector<double> points;
+    for (auto& arg : args) {
+        if (arg.is_empty()) {
+            return Interval::empty();
+        }
+        if (!arg.is_point()) {
+            return Interval::entire();
+        }
+        points.push_back(arg.lo);
+    }
+    double val = eval_args(points, frame);
+    return std::isnan(val) ? Interval::empty() : Interval::outward(val, val, 2);
+}
+
+// the partial derivatives by the arguments that have a derivative
+Dual
+Function::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    if (args.size() == 1) {
+        return eval_dual(args[0], frame);
+    }
+    std::vector<double> values;
+    for (auto& arg : args) {
+        values.push_back(arg.val);
+    }
+    double val = eval_args(values, frame);
+    double der = 0.0;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i].der != 0.0) {
+            double step = std::cbrt(std::numeric_limits<double>::epsilon()) * std::max(std::abs(values[i]), 1.0);
+            values[i] = args[i].val + step;
+            double upper = eval_args(values, frame);
+            values[i] = args[i].val - step;
+            double lower = eval_args(values, frame);
+            values[i] = args[i].val;
+            der += (upper - lower) / (2.0 * step) * args[i].der;
+        }
+    }
+    return Dual(val, der);
+}
+
+void
+Function::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    std::vector<double> call(get_arity());
+    for (size_t i = 0; i < out.size(); ++i) {
+        for (size_t arg = 0; arg < call.size(); ++arg) {
+            call[arg] = args[arg * stride + i];
+        }
+        out[i] = eval_args(call, frame);
+    }
+}
+
+double
+FunctionSqrt::eval(double val, EvalFrame* frame)
 {
 	return std::sqrt(val);
 }
 
+void
+FunctionSqrt::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = std::sqrt(in[i]);
+    }
+}
+
+Interval
+FunctionSqrt::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()
+     || arg.hi < 0.0) {
+        return Interval::empty();
+    }
+    auto range = Interval::outward(std::sqrt(std::max(arg.lo, 0.0)), std::sqrt(arg.hi));
+    return Interval(std::max(range.lo, 0.0), range.hi);
+}
+
+Dual
+FunctionSqrt::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double val = std::sqrt(arg.val);
+    return Dual::chain(arg, val, 0.5 / val);
+}
+
 double
-FunctionCbrt::eval(double val, BaseEval *evalContext)
+FunctionCbrt::eval(double val, EvalFrame* frame)
 {
 	return std::cbrt(val);
 }
 
+void
+FunctionCbrt::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::cbrt(in, out);
+}
+
+Interval
+FunctionCbrt::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    return Interval::increasing(arg, [] (double val) { return std::cbrt(val); });
+}
+
+Dual
+FunctionCbrt::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double val = std::cbrt(arg.val);
+    return Dual::chain(arg, val, 1.0 / (3.0 * val * val));
+}
+
 double
-FunctionLog::eval(double val, BaseEval *evalContext)
+FunctionLog::eval(double val, EvalFrame* frame)
 {
 	return std::log(val);
 }
 
+void
+FunctionLog::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::log(in, out);
+}
+
+Interval
+FunctionLog::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    return log_interval(arg);
+}
+
+Dual
+FunctionLog::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, std::log(arg.val), 1.0 / arg.val);
+}
+
 double
-FunctionExp::eval(double val, BaseEval *evalContext)
+FunctionExp::eval(double val, EvalFrame* frame)
 {
 	return std::exp(val);
 }
 
+void
+FunctionExp::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::exp(in, out);
+}
+
+Interval
+FunctionExp::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    auto range = Interval::increasing(arg, [] (double val) { return std::exp(val); });
+    return arg.is_empty() ? range : Interval(std::max(range.lo, 0.0), range.hi);
+}
+
+Dual
+FunctionExp::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double val = std::exp(arg.val);
+    return Dual::chain(arg, val, val);
+}
+
 double
-FunctionSin::eval(double val, BaseEval *evalContext)
+FunctionSin::eval(double val, EvalFrame* frame)
+{
+    return VectorMath::sin(val, frame->get_right_angle());
+}
+
+void
+FunctionSin::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::sin(in, out, frame->get_right_angle());
+}
+
+Interval
+FunctionSin::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    return Interval::periodic(frame->toRadian(arg)
+                            , [] (double val) { return std::sin(val); }
+                            , VectorMath::RIGHT_ANGLE, 4.0 * VectorMath::RIGHT_ANGLE);
+}
+
+// the angle conversion is linear, so its factor is the inner derivative
+Dual
+FunctionSin::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double rightAngle = frame->get_right_angle();
+    return Dual::chain(arg, VectorMath::sin(arg.val, rightAngle)
+                     , VectorMath::cos(arg.val, rightAngle) * frame->toRadian(1.0));
+}
+
+bool
+FunctionSin::depends_on_context()
 {
-	return std::sin(evalContext->toRadian(val));
+    return true;    // angle unit
 }
 
 double
-FunctionCos::eval(double val, BaseEval *evalContext)
+FunctionCos::eval(double val, EvalFrame* frame)
+{
+    return VectorMath::cos(val, frame->get_right_angle());
+}
+
+void
+FunctionCos::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::cos(in, out, frame->get_right_angle());
+}
+
+Interval
+FunctionCos::eval_interval(const Interval& arg, EvalFrame* frame)
 {
-	return std::cos(evalContext->toRadian(val));
+    return Interval::periodic(frame->toRadian(arg)
+                            , [] (double val) { return std::cos(val); }
+                            , 0.0, 4.0 * VectorMath::RIGHT_ANGLE);
+}
+
+Dual
+FunctionCos::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double rightAngle = frame->get_right_angle();
+    return Dual::chain(arg, VectorMath::cos(arg.val, rightAngle)
+                     , -VectorMath::sin(arg.val, rightAngle) * frame->toRadian(1.0));
+}
+
+bool
+FunctionCos::depends_on_context()
+{
+    return true;    // angle unit
 }
 
 double
-FunctionTan::eval(double val, BaseEval *evalContext)
+FunctionTan::eval(double val, EvalFrame* frame)
 {
-	return std::tan(evalContext->toRadian(val));
+    return VectorMath::tan(val, frame->get_right_angle());
+}
+
+void
+FunctionTan::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::tan(in, out, frame->get_right_angle());
+}
+
+// increasing between the poles at odd multiples of a right angle
+Interval
+FunctionTan::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()) {
+        return Interval::empty();
+    }
+    auto rad = frame->toRadian(arg);
+    double lo = rad.lo;
+    double hi = rad.hi;
+    constexpr double PI = 2.0 * VectorMath::RIGHT_ANGLE;
+    double slack = 4.0 * std::numeric_limits<double>::epsilon() * std::max({std::abs(lo), std::abs(hi), 1.0});
+    double pole = VectorMath::RIGHT_ANGLE + std::ceil((lo - slack - VectorMath::RIGHT_ANGLE) / PI) * PI;
+    if (!(hi - lo < PI)
+     || pole <= hi + slack) {
+        return Interval::entire();
+    }
+    return Interval::outward(std::tan(lo), std::tan(hi), 4);
+}
+
+Dual
+FunctionTan::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    double val = VectorMath::tan(arg.val, frame->get_right_angle());
+    return Dual::chain(arg, val, (1.0 + val * val) * frame->toRadian(1.0));
+}
+
+bool
+FunctionTan::depends_on_context()
+{
+    return true;    // angle unit
 }
 
 double
-FunctionAsin::eval(double val, BaseEval *evalContext)
+FunctionAsin::eval(double val, EvalFrame* frame)
 {
-	return evalContext->fromRadian(std::asin(val));
+	return frame->fromRadian(std::asin(val));
+}
+
+void
+FunctionAsin::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::asin(in, out, frame->get_right_angle());
+}
+
+Interval
+FunctionAsin::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()
+     || arg.hi < -1.0
+     || arg.lo > 1.0) {
+        return Interval::empty();
+    }
+    auto range = Interval::increasing(Interval(std::max(arg.lo, -1.0), std::min(arg.hi, 1.0))
+                                    , [] (double val) { return std::asin(val); });
+    return Interval::outward(frame->fromRadian(range.lo), frame->fromRadian(range.hi));
+}
+
+Dual
+FunctionAsin::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, frame->fromRadian(std::asin(arg.val))
+                     , frame->fromRadian(1.0 / std::sqrt(1.0 - arg.val * arg.val)));
+}
+
+bool
+FunctionAsin::depends_on_context()
+{
+    return true;    // angle unit
 }
 
 double
-FunctionAcos::eval(double val, BaseEval *evalContext)
+FunctionAcos::eval(double val, EvalFrame* frame)
+{
+	return frame->fromRadian(std::acos(val));
+}
+
+void
+FunctionAcos::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::acos(in, out, frame->get_right_angle());
+}
+
+Interval
+FunctionAcos::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()
+     || arg.hi < -1.0
+     || arg.lo > 1.0) {
+        return Interval::empty();
+    }
+    auto range = Interval::outward(std::acos(std::min(arg.hi, 1.0))      // decreasing
+                                 , std::acos(std::max(arg.lo, -1.0)), 2);
+    return Interval::outward(frame->fromRadian(range.lo), frame->fromRadian(range.hi));
+}
+
+Dual
+FunctionAcos::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, frame->fromRadian(std::acos(arg.val))
+                     , frame->fromRadian(-1.0 / std::sqrt(1.0 - arg.val * arg.val)));
+}
+
+bool
+FunctionAcos::depends_on_context()
 {
-	return evalContext->fromRadian(std::acos(val));
+    return true;    // angle unit
 }
 
 double
-FunctionAtan::eval(double val, BaseEval *evalContext)
+FunctionAtan::eval(double val, EvalFrame* frame)
 {
-	return evalContext->fromRadian(std::atan(val));
+	return frame->fromRadian(std::atan(val));
+}
+
+void
+FunctionAtan::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::atan(in, out, frame->get_right_angle());
+}
+
+Interval
+FunctionAtan::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    auto range = Interval::increasing(arg, [] (double val) { return std::atan(val); });
+    return arg.is_empty()
+            ? range
+            : Interval::outward(frame->fromRadian(range.lo), frame->fromRadian(range.hi));
+}
+
+Dual
+FunctionAtan::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, frame->fromRadian(std::atan(arg.val))
+                     , frame->fromRadian(1.0 / (1.0 + arg.val * arg.val)));
+}
+
+bool
+FunctionAtan::depends_on_context()
+{
+    return true;    // angle unit
 }
 
 double
-FunctionLog2::eval(double val, BaseEval *evalContext)
+FunctionLog2::eval(double val, EvalFrame* frame)
 {
 	return std::log2(val);
 }
 
+void
+FunctionLog2::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::log2(in, out);
+}
+
+Interval
+FunctionLog2::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()
+     || arg.hi < 0.0) {
+        return Interval::empty();
+    }
+    return Interval::increasing(Interval(std::max(arg.lo, 0.0), arg.hi)
+                              , [] (double val) { return std::log2(val); });
+}
+
+Dual
+FunctionLog2::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, std::log2(arg.val), 1.0 / (arg.val * std::numbers::ln2));
+}
+
 double
-FunctionLog10::eval(double val, BaseEval *evalContext)
+FunctionLog10::eval(double val, EvalFrame* frame)
 {
 	return std::log10(val);
 }
 
+void
+FunctionLog10::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    VectorMath::log10(in, out);
+}
+
+Interval
+FunctionLog10::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()
+     || arg.hi < 0.0) {
+        return Interval::empty();
+    }
+    return Interval::increasing(Interval(std::max(arg.lo, 0.0), arg.hi)
+                              , [] (double val) { return std::log10(val); });
+}
+
+Dual
+FunctionLog10::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, std::log10(arg.val), 1.0 / (arg.val * std::numbers::ln10));
+}
+
 double
-FunctionAbs::eval(double val, BaseEval *evalContext)
+FunctionAbs::eval(double val, EvalFrame* frame)
 {
 	return std::fabs(val);
 }
 
+void
+FunctionAbs::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = std::fabs(in[i]);
+    }
+}
+
+Interval
+FunctionAbs::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    return Interval::abs(arg);
+}
+
+Dual
+FunctionAbs::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return Dual::chain(arg, std::fabs(arg.val), arg.val < 0.0 ? -1.0 : (arg.val > 0.0 ? 1.0 : 0.0));
+}
+
 double
-FunctionFactorial::eval(double val, BaseEval *evalContext)
+FunctionFactorial::eval(double val, EvalFrame* frame)
 {
+    if (val > ARGUMENT_MAX) {     // also for inf, that would never end
+        return std::numeric_limits<double>::infinity();
+    }
     double fac = 1.0;
     while (val > 1.0) {
         fac *= val;
@@ -112,8 +603,329 @@ FunctionFactorial::eval(double val, BaseEval *evalContext)
 	return fac;
 }
 
+// non decreasing, but each factor may round
+Interval
+FunctionFactorial::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    if (arg.is_empty()) {
+        return Interval::empty();
+    }
+    if (!std::isfinite(arg.hi)
+     || arg.hi > ARGUMENT_MAX) {
+        return Interval::outward(eval(arg.lo, frame), std::numeric_limits<double>::infinity()
+                               , static_cast<int>(ARGUMENT_MAX) + 1);
+    }
+    auto factors = static_cast<int>(std::max(arg.hi, 1.0));
+    return Interval::outward(eval(arg.lo, frame), eval(arg.hi, frame), factors + 1);
+}
+
+size_t
+FunctionAtan2::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionAtan2::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return frame->fromRadian(std::atan2(args[0], args[1]));
+}
+
+// the angles of a region are not that easy, so just within a turn
+Interval
+FunctionAtan2::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    if (args[0].is_empty()
+     || args[1].is_empty()
+     || all_points(args)) {
+        return Function::eval_interval_args(args, frame);
+    }
+    return Interval::outward(frame->fromRadian(-std::numbers::pi), frame->fromRadian(std::numbers::pi));
+}
+
+Dual
+FunctionAtan2::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    const Dual& y = args[0];
+    const Dual& x = args[1];
+    double radius2 = x.val * x.val + y.val * y.val;
+    return Dual(frame->fromRadian(std::atan2(y.val, x.val))
+              , frame->fromRadian((x.val * y.der - y.val * x.der) / radius2));
+}
+
+void
+FunctionAtan2::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* y = args.data();
+    const double* x = y + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = frame->fromRadian(std::atan2(y[i], x[i]));
+    }
+}
+
+bool
+FunctionAtan2::depends_on_context()
+{
+    return true;    // angle unit
+}
+
+size_t
+FunctionHypot::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionHypot::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::hypot(args[0], args[1]);
+}
+
+// increasing with the magnitude of both
+Interval
+FunctionHypot::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    if (args[0].is_empty()
+     || args[1].is_empty()) {
+        return Interval::empty();
+    }
+    auto x = Interval::abs(args[0]);
+    auto y = Interval::abs(args[1]);
+    return Interval::outward(std::hypot(x.lo, y.lo), std::hypot(x.hi, y.hi), 2);
+}
+
+Dual
+FunctionHypot::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    const Dual& x = args[0];
+    const Dual& y = args[1];
+    double val = std::hypot(x.val, y.val);
+    return Dual(val, val > 0.0 ? (x.val * x.der + y.val * y.der) / val : 0.0);
+}
+
+void
+FunctionHypot::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* x = args.data();
+    const double* y = x + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::hypot(x[i], y[i]);
+    }
+}
+
+size_t
+FunctionMin::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionMin::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::fmin(args[0], args[1]);
+}
+
+Interval
+FunctionMin::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return Interval::min(args[0], args[1]);
+}
+
+// the derivative of the smaller one
+Dual
+FunctionMin::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    return args[1].val < args[0].val ? args[1] : args[0];
+}
+
+void
+FunctionMin::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* left = args.data();
+    const double* right = left + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::fmin(left[i], right[i]);
+    }
+}
+
+size_t
+FunctionMax::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionMax::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::fmax(args[0], args[1]);
+}
+
+Interval
+FunctionMax::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return Interval::max(args[0], args[1]);
+}
+
+Dual
+FunctionMax::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    return args[1].val > args[0].val ? args[1] : args[0];
+}
+
+void
+FunctionMax::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* left = args.data();
+    const double* right = left + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::fmax(left[i], right[i]);
+    }
+}
+
+size_t
+FunctionPow::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionPow::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::pow(args[0], args[1]);
+}
+
+Interval
+FunctionPow::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return Interval::pow(args[0], args[1]);
+}
+
+Dual
+FunctionPow::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    return Dual::pow(args[0], args[1]);
+}
+
+void
+FunctionPow::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* base = args.data();
+    const double* exponent = base + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::pow(base[i], exponent[i]);
+    }
+}
+
+size_t
+FunctionFma::get_arity()
+{
+    return 3;
+}
+
+double
+FunctionFma::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::fma(args[0], args[1], args[2]);
+}
+
+// the separate operations are rounded outward, so they enclose the fused one
+Interval
+FunctionFma::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return Interval::add(Interval::mul(args[0], args[1]), args[2]);
+}
+
+Dual
+FunctionFma::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    const Dual& x = args[0];
+    const Dual& y = args[1];
+    const Dual& z = args[2];
+    return Dual(std::fma(x.val, y.val, z.val)
+              , std::fma(x.der, y.val, std::fma(x.val, y.der, z.der)));
+}
+
+void
+FunctionFma::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* x = args.data();
+    const double* y = x + stride;
+    const double* z = y + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::fma(x[i], y[i], z[i]);
+    }
+}
+
+size_t
+FunctionClamp::get_arity()
+{
+    return 3;
+}
+
+// unlike std::clamp defined for lo > hi, that gives hi
+double
+FunctionClamp::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::fmin(std::fmax(args[0], args[1]), args[2]);
+}
+
+Interval
+FunctionClamp::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return Interval::min(Interval::max(args[0], args[1]), args[2]);
+}
+
+// the derivative of the limit that applies
+Dual
+FunctionClamp::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    Dual val = args[1].val > args[0].val ? args[1] : args[0];
+    return args[2].val < val.val ? args[2] : val;
+}
+
+void
+FunctionClamp::eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame)
+{
+    const double* x = args.data();
+    const double* lower = x + stride;
+    const double* upper = lower + stride;
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = std::fmin(std::fmax(x[i], lower[i]), upper[i]);
+    }
+}
+
+size_t
+FunctionLogb::get_arity()
+{
+    return 2;
+}
+
+double
+FunctionLogb::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return std::log(args[0]) / std::log(args[1]);
+}
+
+Interval
+FunctionLogb::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    if (all_points(args)) {     // e.g. logb(8; 2) = 3 stays a point
+        return Function::eval_interval_args(args, frame);
+    }
+    return Interval::div(log_interval(args[0]), log_interval(args[1]));
+}
+
+Dual
+FunctionLogb::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    const Dual& x = args[0];
+    const Dual& base = args[1];
+    return Dual::div(Dual::chain(x, std::log(x.val), 1.0 / x.val)
+                   , Dual::chain(base, std::log(base.val), 1.0 / base.val));
+}
+
 //std::vector<double>
-//FunctionPrimfact::eval(double argument, BaseEval *evalContext)
+//FunctionPrimfact::eval(double argument, EvalFrame* frame)
 //{
 //    std::vector<double> ret;
 //    ret.reserve(16);
@@ -18,7 +18,12 @@
 
 #pragma once
 
-class BaseEval;
+#include <span>
+
+#include "Interval.hpp"
+#include "Dual.hpp"
+
+class EvalFrame;
 
 // provide the usual suspects for functions
 class Function
@@ -27,7 +32,31 @@ public:
     Function() = default;
     virtual ~Function() = default;
 
-    virtual double eval(double argument, BaseEval *evalContext) = 0;
+    // the single argument, the default fails for a function with more
+    virtual double eval(double argument, EvalFrame* frame);
+    // evaluate a block of arguments (in and out may be the same),
+    //   override if there is a faster way than calling eval for each
+    virtual void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame);
+    // enclosure of the results for all arguments within arg,
+    //   the default is exact just for a point, otherwise unbounded
+    virtual Interval eval_interval(const Interval& arg, EvalFrame* frame);
+    // value and derivative, the default uses a central difference
+    virtual Dual eval_dual(const Dual& arg, EvalFrame* frame);
+    // true if the result depends on the settings of the context e.g. angle unit,
+    //   otherwise the function may be evaluated on compile for a constant argument
+    virtual bool depends_on_context();
+    // the count of arguments, a function with more than one
+    //   is called by the *_args methods
+    virtual size_t get_arity();
+    // the defaults pass a single argument to the methods above,
+    //   for more arguments the interval is exact just for points,
+    //   and the derivative uses central differences
+    virtual double eval_args(std::span<const double> args, EvalFrame* frame);
+    virtual Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame);
+    virtual Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame);
+    // a block of calls, the argument k for call i is args[k * stride + i],
+    //   out may be the first argument row
+    virtual void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame);
 private:
 
 };
@@ -35,83 +64,221 @@ private:
 class FunctionSqrt : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionCbrt : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionLog : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionExp : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionSin : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionCos : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionTan : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionAsin : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionAcos : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionAtan : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
 };
 
 class FunctionLog2 : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionLog10 : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionAbs : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
 };
 
 class FunctionFactorial : public Function
 {
 public:
-    double eval(double argument, BaseEval *evalContext) override;
+    double eval(double argument, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+
+    // beyond this the product overflows anyway
+    static constexpr double ARGUMENT_MAX{171.0};
+};
+
+// the functions with more arguments, these take
+//   the arguments in the order they are written
+
+// atan2(y; x) the angle of the point x, y
+class FunctionAtan2 : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+    bool depends_on_context() override;
+};
+
+// hypot(x; y) without overflow for large x or y
+class FunctionHypot : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+class FunctionMin : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+class FunctionMax : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+// pow(x; y) same as x^y
+class FunctionPow : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+// fma(x; y; z) x*y + z rounded once
+class FunctionFma : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+// clamp(x; lo; hi) x limited to [lo, hi]
+class FunctionClamp : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+    void eval_batch_args(std::span<const double> args, size_t stride, std::span<double> out, EvalFrame* frame) override;
+};
+
+// logb(x; b) the logarithm of x to base b
+class FunctionLogb : public Function
+{
+public:
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
 };
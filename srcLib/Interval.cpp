@@ -0,0 +1,327 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "Interval.hpp"
+#include "Program.hpp"
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// products of bounds, where 0 * inf gives 0 as the limit
+double
+mul_bound(double left, double right)
+{
+    if (left == 0.0
+     || right == 0.0) {
+        return 0.0;
+    }
+    return left * right;
+}
+
+// is there a phase + k * period within [lo, hi]
+bool
+contains_phase(double lo, double hi, double phase, double period)
+{
+    double k = std::ceil((lo - phase) / period);
+    return phase + k * period <= hi;
+}
+
+}
+
+Interval::Interval(double val)
+: lo{val}
+, hi{val}
+{
+}
+
+Interval::Interval(double lower, double upper)
+: lo{lower}
+, hi{upper}
+{
+}
+
+bool
+Interval::is_empty() const
+{
+    return std::isnan(lo)
+        || std::isnan(hi);
+}
+
+bool
+Interval::is_point() const
+{
+    return lo == hi;
+}
+
+bool
+Interval::is_bounded() const
+{
+    return std::isfinite(lo)
+        && std::isfinite(hi);
+}
+
+bool
+Interval::contains(double val) const
+{
+    return lo <= val
+        && val <= hi;
+}
+
+double
+Interval::width() const
+{
+    return hi - lo;
+}
+
+Interval
+Interval::entire()
+{
+    return Interval(-INF, INF);
+}
+
+Interval
+Interval::empty()
+{
+    return Interval(std::numeric_limits<double>::quiet_NaN()
+                  , std::numeric_limits<double>::quiet_NaN());
+}
+
+// a NaN bound from e.g. inf - inf means unbounded
+Interval
+Interval::outward(double lower, double upper, int ulps)
+{
+    if (std::isnan(lower)) {
+        lower = -INF;
+    }
+    if (std::isnan(upper)) {
+        upper = INF;
+    }
+    for (int i = 0; i < ulps; ++i) {
+        lower = std::nextafter(lower, -INF);
+        upper = std::nextafter(upper, INF);
+    }
+    return Interval(lower, upper);
+}
+
+Interval
+Interval::neg(const Interval& val)
+{
+    return Interval(-val.hi, -val.lo);
+}
+
+Interval
+Interval::add(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    return outward(left.lo + right.lo, left.hi + right.hi);
+}
+
+Interval
+Interval::sub(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    return outward(left.lo - right.hi, left.hi - right.lo);
+}
+
+Interval
+Interval::mul(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    double p[] = {mul_bound(left.lo, right.lo), mul_bound(left.lo, right.hi)
+                , mul_bound(left.hi, right.lo), mul_bound(left.hi, right.hi)};
+    return outward(*std::min_element(std::begin(p), std::end(p))
+                 , *std::max_element(std::begin(p), std::end(p)));
+}
+
+Interval
+Interval::div(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    if (right.contains(0.0)) {
+        return entire();        // could be split in two, but one interval is kept
+    }
+    double q[] = {left.lo / right.lo, left.lo / right.hi
+                , left.hi / right.lo, left.hi / right.hi};
+    if (std::any_of(std::begin(q), std::end(q), [] (double v) { return std::isnan(v); })) {
+        return entire();        // inf / inf
+    }
+    return outward(*std::min_element(std::begin(q), std::end(q))
+                 , *std::max_element(std::begin(q), std::end(q)));
+}
+
+// fmod keeps the sign of left and is smaller than |right|
+Interval
+Interval::mod(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    if (left.is_point()
+     && right.is_point()) {
+        double val = std::fmod(left.lo, right.lo);
+        return std::isnan(val) ? empty() : Interval(val);
+    }
+    double limit = std::max(std::abs(right.lo), std::abs(right.hi));
+    return Interval(left.lo >= 0.0 ? 0.0 : std::max(left.lo, -limit)
+                  , left.hi <= 0.0 ? 0.0 : std::min(left.hi, limit));
+}
+
+// for a positive base pow is monotonic in both arguments,
+//   so the extremes are found at the corners
+Interval
+Interval::pow(const Interval& base, const Interval& exponent)
+{
+    if (base.is_empty()
+     || exponent.is_empty()) {
+        return empty();
+    }
+    if (exponent.is_point()
+     && exponent.lo == std::trunc(exponent.lo)
+     && std::abs(exponent.lo) <= static_cast<double>(std::numeric_limits<uint32_t>::max())) {
+        return powi(base, exponent.lo);
+    }
+    if (base.lo < 0.0) {
+        if (!exponent.is_point()) {
+            return entire();    // integral exponents within the range allow negative bases
+        }
+        if (base.hi < 0.0) {
+            return empty();
+        }
+        return pow(Interval(0.0, base.hi), exponent);
+    }
+    double p[] = {std::pow(base.lo, exponent.lo), std::pow(base.lo, exponent.hi)
+                , std::pow(base.hi, exponent.lo), std::pow(base.hi, exponent.hi)};
+    return outward(*std::min_element(std::begin(p), std::end(p))
+                 , *std::max_element(std::begin(p), std::end(p)), 2);
+}
+
+Interval
+Interval::powi(const Interval& base, double exponent)
+{
+    if (base.is_empty()) {
+        return empty();
+    }
+    if (exponent < 0.0) {
+        return div(Interval(1.0), powi(base, -exponent));
+    }
+    if (exponent == 0.0) {
+        return Interval(1.0);
+    }
+    // each squaring or product may round
+    int ulps = 2 * static_cast<int>(std::ilogb(exponent)) + 2;
+    auto n = static_cast<uint32_t>(exponent);
+    double lo = Program::powi(base.lo, exponent);
+    double hi = Program::powi(base.hi, exponent);
+    if (n & 1u
+     || base.lo >= 0.0) {
+        return outward(lo, hi, ulps);           // increasing
+    }
+    if (base.hi <= 0.0) {
+        return outward(hi, lo, ulps);           // decreasing
+    }
+    return Interval(0.0, outward(0.0, std::max(lo, hi), ulps).hi);   // even, with the minimum at 0
+}
+
+Interval
+Interval::abs(const Interval& val)
+{
+    if (val.lo >= 0.0) {
+        return val;
+    }
+    if (val.hi <= 0.0) {
+        return neg(val);
+    }
+    return Interval(0.0, std::max(-val.lo, val.hi));
+}
+
+Interval
+Interval::hull(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()) {
+        return right;
+    }
+    if (right.is_empty()) {
+        return left;
+    }
+    return Interval(std::min(left.lo, right.lo), std::max(left.hi, right.hi));
+}
+
+Interval
+Interval::min(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    return Interval(std::min(left.lo, right.lo), std::min(left.hi, right.hi));
+}
+
+Interval
+Interval::max(const Interval& left, const Interval& right)
+{
+    if (left.is_empty()
+     || right.is_empty()) {
+        return empty();
+    }
+    return Interval(std::max(left.lo, right.lo), std::max(left.hi, right.hi));
+}
+
+Interval
+Interval::periodic(const Interval& arg, double (*fun)(double), double phase, double period)
+{
+    if (arg.is_empty()) {
+        return empty();
+    }
+    // beyond this the spacing of doubles gets close to the period
+    constexpr double PERIODIC_LIMIT{1.0e15};
+    if (!(arg.width() < period)
+     || std::abs(arg.lo) > PERIODIC_LIMIT
+     || std::abs(arg.hi) > PERIODIC_LIMIT) {
+        return Interval(-1.0, 1.0);
+    }
+    // as the argument, phase and period are rounded, look at a slightly wider range
+    double slack = 4.0 * std::numeric_limits<double>::epsilon() * std::max({std::abs(arg.lo), std::abs(arg.hi), 1.0});
+    double lo = arg.lo - slack;
+    double hi = arg.hi + slack;
+    auto range = outward(std::min(fun(arg.lo), fun(arg.hi)) - slack
+                       , std::max(fun(arg.lo), fun(arg.hi)) + slack, 2);
+    if (contains_phase(lo, hi, phase, period)) {
+        range.hi = 1.0;
+    }
+    if (contains_phase(lo, hi, phase + period / 2.0, period)) {
+        range.lo = -1.0;
+    }
+    return Interval(std::max(range.lo, -1.0), std::min(range.hi, 1.0));
+}
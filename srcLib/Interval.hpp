@@ -0,0 +1,78 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <limits>
+#include <cstdint>
+
+/*
+ * a closed range of reals that encloses all results
+ *   of a evaluation for arguments from ranges,
+ *   the bounds are rounded outward, so the enclosure holds
+ *   despite rounding. Values outside the domain of a function
+ *   are dropped e.g. sqrt([-1, 4]) = [0, 2],
+ *   if nothing remains the interval is empty (bounds are NaN).
+ */
+struct Interval
+{
+    double lo{};
+    double hi{};
+
+    Interval() = default;
+    explicit Interval(double val);
+    Interval(double lower, double upper);
+
+    bool is_empty() const;
+    bool is_point() const;
+    bool is_bounded() const;
+    bool contains(double val) const;
+    double width() const;
+
+    static Interval entire();
+    static Interval empty();
+    // bounds widened by ulps units in the last place
+    static Interval outward(double lower, double upper, int ulps = 1);
+    // for a non decreasing function
+    template<typename F>
+    static Interval increasing(const Interval& arg, F fun, int ulps = 2)
+    {
+        if (arg.is_empty()) {
+            return empty();
+        }
+        return outward(fun(arg.lo), fun(arg.hi), ulps);
+    }
+
+    static Interval neg(const Interval& val);
+    static Interval add(const Interval& left, const Interval& right);
+    static Interval sub(const Interval& left, const Interval& right);
+    static Interval mul(const Interval& left, const Interval& right);
+    static Interval div(const Interval& left, const Interval& right);
+    static Interval mod(const Interval& left, const Interval& right);
+    static Interval pow(const Interval& base, const Interval& exponent);
+    static Interval powi(const Interval& base, double exponent);
+    static Interval abs(const Interval& val);
+    // the smallest interval that contains both
+    static Interval hull(const Interval& left, const Interval& right);
+    // the enclosures of min and max, exact as no rounding is involved
+    static Interval min(const Interval& left, const Interval& right);
+    static Interval max(const Interval& left, const Interval& right);
+    // e.g. sin with the maximum at phase + k * period
+    //   and the minimum half a period later, the argument is in radian
+    static Interval periodic(const Interval& arg, double (*fun)(double), double phase, double period);
+};
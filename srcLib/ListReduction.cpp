@@ -0,0 +1,276 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <psc_format.hpp>
+#include <psc_i18n.hpp>
+
+#include "ListReduction.hpp"
+#include "EvalFrame.hpp"
+#include "Token.hpp"
+#include "VectorMath.hpp"
+
+ListReduction::ListReduction(Kind kind, std::vector<PtrProgram>&& expressions
+                           , std::vector<Input>&& inputs, size_t paramCount)
+: m_kind{kind}
+, m_expressions{std::move(expressions)}
+, m_inputs{std::move(inputs)}
+, m_paramCount{paramCount}
+{
+    auto usesParams = [paramCount] (const PtrProgram& program) {
+        auto& code = program->get_code();
+        return std::any_of(code.begin(), code.end(), [paramCount] (const Instruction& instr) {
+            return (instr.code == OpCode::Param && instr.index < paramCount)
+                || instr.code == OpCode::Form
+                || instr.code == OpCode::Reduce;
+        });
+    };
+    for (auto& expression : m_expressions) {
+        m_usesParams = m_usesParams || usesParams(expression);
+    }
+    for (auto& input : m_inputs) {
+        for (auto& element : input.elements) {
+            m_usesParams = m_usesParams || usesParams(element);
+        }
+    }
+}
+
+double
+ListReduction::eval(std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<std::vector<double>> literals;
+    std::vector<std::span<const double>> rows;
+    size_t count = collect(params, frame, literals, rows);
+    std::vector<double> values(count);
+    frame.eval_rows(*m_expressions[0], rows, values);
+    switch (m_kind) {
+    case Kind::Sum:
+        return VectorMath::sum(values);
+    case Kind::Mean:
+        return count > 0
+                ? VectorMath::sum(values) / static_cast<double>(count)
+                : std::numeric_limits<double>::quiet_NaN();
+    case Kind::Stddev:
+        return stddev(values);
+    case Kind::Min:
+        return VectorMath::min(values);
+    case Kind::Max:
+        return VectorMath::max(values);
+    case Kind::Norm:
+        return norm(values);
+    case Kind::Dot: {
+        std::vector<double> other(count);
+        frame.eval_rows(*m_expressions[1], rows, other);
+        return VectorMath::dot(values, other);
+    }
+    default:
+        return static_cast<double>(count);
+    }
+}
+
+std::vector<double>
+ListReduction::eval_list(std::span<const double> params, EvalFrame& frame)
+{
+    std::vector<std::vector<double>> literals;
+    std::vector<std::span<const double>> rows;
+    std::vector<double> values(collect(params, frame, literals, rows));
+    frame.eval_rows(*m_expressions[0], rows, values);
+    return values;
+}
+
+// the lists have to be of the same length, or of one element
+size_t
+ListReduction::collect(std::span<const double> params, EvalFrame& frame
+                     , std::vector<std::vector<double>>& literals
+                     , std::vector<std::span<const double>>& rows)
+{
+    literals.reserve(m_inputs.size());      // keep the rows valid
+    for (size_t param = 0; param < m_paramCount; ++param) {
+        rows.emplace_back(&params[param], 1);
+    }
+    size_t count = 1;
+    bool isCounted = false;
+    for (auto& input : m_inputs) {
+        std::span<const double> row;
+        if (input.literal) {
+            auto& literal = literals.emplace_back();
+            for (auto& element : input.elements) {
+                literal.push_back(frame.eval(*element, params.first(m_paramCount)));
+            }
+            row = literal;
+        }
+        else {
+            row = frame.get_list(input.slot);
+        }
+        if (row.size() != 1) {
+            if (isCounted
+             && row.size() != count) {
+                auto size = row.size();
+                throw EvalError(psc::fmt::vformat(
+                        _("The lists have different lengths {} and {}")
+                        , psc::fmt::make_format_args(count, size)));
+            }
+            count = row.size();
+            isCounted = true;
+        }
+        rows.push_back(row);
+    }
+    return count;
+}
+
+double
+ListReduction::stddev(std::vector<double>& values)
+{
+    if (values.size() < 2) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double count = static_cast<double>(values.size());
+    double mean = VectorMath::sum(values) / count;
+    for (auto& value : values) {
+        value -= mean;
+    }
+    return std::sqrt(VectorMath::dot(values, values) / (count - 1.0));
+}
+
+// scaled by the largest magnitude, so the squares neither overflow nor underflow
+double
+ListReduction::norm(std::vector<double>& values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    for (auto& value : values) {
+        value = std::abs(value);
+    }
+    double scale = VectorMath::max(values);
+    if (!(scale > 0.0)
+     || std::isinf(scale)) {
+        return scale;
+    }
+    for (auto& value : values) {
+        value /= scale;
+    }
+    return scale * std::sqrt(VectorMath::dot(values, values));
+}
+
+Interval
+ListReduction::eval_interval(std::span<const Interval> params, EvalFrame& frame)
+{
+    std::vector<double> values;
+    for (auto& param : params.first(m_paramCount)) {
+        if (param.is_empty()) {
+            return Interval::empty();
+        }
+        if (!param.is_point()
+         && m_usesParams) {
+            return Interval::entire();
+        }
+        values.push_back(param.lo);
+    }
+    double val = eval(values, frame);
+    return std::isnan(val) ? Interval::empty() : Interval::outward(val, val, 2);
+}
+
+Dual
+ListReduction::eval_dual(std::span<const Dual> params, EvalFrame& frame)
+{
+    std::vector<double> values;
+    std::vector<double> direction;
+    double magnitude = 1.0;
+    for (auto& param : params.first(m_paramCount)) {
+        values.push_back(param.val);
+        direction.push_back(param.der);
+        magnitude = std::max(magnitude, std::abs(param.val));
+    }
+    bool constant = !m_usesParams
+            || std::all_of(direction.begin(), direction.end(), [] (double der) { return der == 0.0; });
+    double val = eval(values, frame);
+    if (constant) {
+        return Dual(val);
+    }
+    double step = std::cbrt(std::numeric_limits<double>::epsilon()) * magnitude;
+    auto shifted = [&] (double by) {
+        std::vector<double> moved(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            moved[i] = values[i] + by * direction[i];
+        }
+        return eval(moved, frame);
+    };
+    return Dual(val, (shifted(step) - shifted(-step)) / (2.0 * step));
+}
+
+bool
+ListReduction::uses_params() const
+{
+    return m_usesParams;
+}
+
+const std::vector<PtrProgram>&
+ListReduction::get_expressions() const
+{
+    return m_expressions;
+}
+
+const std::vector<ListReduction::Input>&
+ListReduction::get_inputs() const
+{
+    return m_inputs;
+}
+
+bool
+ListReduction::is_reduction(const Glib::ustring& name)
+{
+    Kind kind;
+    return find(name, 1, &kind)
+        || find(name, 2, &kind);
+}
+
+bool
+ListReduction::find(const Glib::ustring& name, size_t count, Kind* kind)
+{
+    if (count == 2) {
+        *kind = Kind::Dot;
+        return name == "dot";
+    }
+    if (count != 1) {
+        return false;
+    }
+    if (name == "sum") {
+        *kind = Kind::Sum;
+    }
+    else if (name == "mean") {
+        *kind = Kind::Mean;
+    }
+    else if (name == "stddev") {
+        *kind = Kind::Stddev;
+    }
+    else if (name == "min") {
+        *kind = Kind::Min;
+    }
+    else if (name == "max") {
+        *kind = Kind::Max;
+    }
+    else if (name == "norm") {
+        *kind = Kind::Norm;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
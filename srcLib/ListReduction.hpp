@@ -0,0 +1,97 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <glibmm.h>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Program.hpp"
+#include "Interval.hpp"
+#include "Dual.hpp"
+
+class EvalFrame;
+
+/*
+ * a reduction of lists e.g. mean(data) or dot(a; b),
+ *   or the list assigned by e.g. c = 2 * a + b.
+ *   The expressions are compiled with the parameters of the
+ *   enclosing program, followed by a parameter for each input list,
+ *   so they are evaluated element wise by batch over the lists,
+ *   a value or a list of one element is used for all elements.
+ */
+class ListReduction
+{
+public:
+    enum class Kind
+    {
+        List,       // the values, for a assignment
+        Sum,
+        Mean,
+        Stddev,     // of a sample, divided by count - 1
+        Min,
+        Max,
+        Norm,       // euclidean
+        Dot
+    };
+    // a list variable, or a list literal with a program for each element
+    struct Input
+    {
+        size_t slot{};
+        std::vector<PtrProgram> elements;
+        bool literal{false};
+    };
+
+    // paramCount is the count of parameters of the enclosing program
+    ListReduction(Kind kind, std::vector<PtrProgram>&& expressions
+                , std::vector<Input>&& inputs, size_t paramCount);
+    explicit ListReduction(const ListReduction& orig) = delete;
+    virtual ~ListReduction() = default;
+
+    double eval(std::span<const double> params, EvalFrame& frame);
+    // the values of the expression for each element
+    std::vector<double> eval_list(std::span<const double> params, EvalFrame& frame);
+    // exact just for points, otherwise unbounded
+    Interval eval_interval(std::span<const Interval> params, EvalFrame& frame);
+    // a central difference along the derivatives
+    Dual eval_dual(std::span<const Dual> params, EvalFrame& frame);
+    // false if the result is the same for all parameters
+    bool uses_params() const;
+    const std::vector<PtrProgram>& get_expressions() const;
+    const std::vector<Input>& get_inputs() const;
+
+    // the names that are parsed as reduction
+    static bool is_reduction(const Glib::ustring& name);
+    // false if name with count arguments is no reduction,
+    //   e.g. sum of 4 arguments is a form, min of 2 a function
+    static bool find(const Glib::ustring& name, size_t count, Kind* kind);
+private:
+    // the rows to evaluate the expressions, returns the count of elements
+    size_t collect(std::span<const double> params, EvalFrame& frame
+                 , std::vector<std::vector<double>>& literals
+                 , std::vector<std::span<const double>>& rows);
+    static double stddev(std::vector<double>& values);
+    static double norm(std::vector<double>& values);
+
+    Kind m_kind;
+    std::vector<PtrProgram> m_expressions;     // two for dot, otherwise one
+    std::vector<Input> m_inputs;
+    size_t m_paramCount;
+    bool m_usesParams{false};
+};
@@ -17,5 +17,79 @@
  */
 
 
+#include <charconv>
+#include <clocale>
+
 #include "NumberFormat.hpp"
 
+NumberFormat::NumberFormat()
+: m_decimalPoint{std::localeconv()->decimal_point}
+{
+}
+
+NumberFormat::NumberFormat(const std::string& decimalPoint)
+: m_decimalPoint{decimalPoint}
+{
+}
+
+const std::string&
+NumberFormat::get_decimal_point() const
+{
+    return m_decimalPoint;
+}
+
+// locale independent conversion by from_chars,
+//   if the locale uses a different decimal point the number is copied
+//   with the decimal point replaced.
+bool
+NumberFormat::parse_decimal(std::string_view remain, double& value, std::string::size_type* offs) const
+{
+    const char* start = remain.data();
+    if (m_decimalPoint == ".") {
+        auto [ptr, ec] = std::from_chars(start, start + remain.size(), value);
+        *offs = ec == std::errc() ? static_cast<std::string::size_type>(ptr - start) : 0;
+        return ec == std::errc();
+    }
+    std::string number;
+    size_t pos = 0;
+    auto digits = [&] {
+        size_t begin = pos;
+        while (pos < remain.size() && remain[pos] >= '0' && remain[pos] <= '9') {
+            ++pos;
+        }
+        number.append(remain.substr(begin, pos - begin));
+    };
+    digits();
+    if (remain.substr(pos).starts_with(m_decimalPoint)) {
+        number.push_back('.');
+        pos += m_decimalPoint.size();
+        digits();
+    }
+    if (pos < remain.size()
+     && (remain[pos] == 'e' || remain[pos] == 'E')) {
+        size_t mantissa = pos;
+        size_t used = number.size();
+        number.push_back('e');
+        ++pos;
+        if (pos < remain.size()
+         && (remain[pos] == '+' || remain[pos] == '-')) {
+            number.push_back(remain[pos]);
+            ++pos;
+        }
+        size_t expStart = pos;
+        digits();
+        if (pos == expStart) {      // no exponent, leave e for a following identifier
+            pos = mantissa;
+            number.resize(used);
+        }
+    }
+    auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (ec != std::errc()
+     || ptr != number.data() + number.size()) {
+        *offs = 0;
+        return false;
+    }
+    *offs = pos;
+    return true;
+}
+
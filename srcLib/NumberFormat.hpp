@@ -20,15 +20,25 @@
 
 #include <glibmm.h>
 #include <string>
+#include <string_view>
 
 // Allow specific/switchable number formating e.g. octal
 class NumberFormat
 {
 public:
+    NumberFormat();
+    virtual ~NumberFormat() = default;
 
-    virtual bool parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const = 0;
+    // parse the number at the start of remain, offs receives the number of bytes used
+    virtual bool parse(std::string_view remain, double& value, std::string::size_type* offs) const = 0;
+    // decimal point of the locale, as it was on creation
+    const std::string& get_decimal_point() const;
+protected:
+    explicit NumberFormat(const std::string& decimalPoint);
+    // decimal floating point number using the decimal point of the locale
+    bool parse_decimal(std::string_view remain, double& value, std::string::size_type* offs) const;
 private:
-
+    std::string m_decimalPoint;
 };
 
 using PtrNumberFormat = std::shared_ptr<NumberFormat>;
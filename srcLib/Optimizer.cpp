@@ -0,0 +1,303 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4; coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "Optimizer.hpp"
+#include "BaseEval.hpp"
+#include "EvalFrame.hpp"
+
+Optimizer::Optimizer(BaseEval* evalContext, const VariableStore& variables)
+: m_evalContext{evalContext}
+, m_variables{variables}
+{
+}
+
+// returns the optimized copy, or the given program if it has a unexpected form
+PtrProgram
+Optimizer::optimize(const PtrProgram& program)
+{
+    if (!build(program)) {
+        return program;
+    }
+    size_t root = simplify(m_root);
+    auto optimized = std::make_shared<Program>();
+    optimized->set_param_count(program->get_param_count());
+    if (program->is_assign()) {
+        optimized->set_assign(program->get_assign());
+    }
+    emit(root, program, *optimized);
+    return optimized;
+}
+
+// convert the postfix code to a tree, false if it is not a single expression or too deep
+bool
+Optimizer::build(const PtrProgram& program)
+{
+    m_nodes.clear();
+    std::vector<size_t> stack;
+    for (auto& instr : program->get_code()) {
+        Node node{instr};
+        switch (Program::stack_effect(instr)) {
+        case 1:
+            if (instr.code == OpCode::Dup) {
+                return false;   // shares a operand, already optimized
+            }
+            break;
+        case 0:
+            if (stack.empty()) {
+                return false;
+            }
+            node.right = stack.back();
+            stack.pop_back();
+            break;
+        default:
+            if (instr.code == OpCode::CallN) {
+                if (stack.size() < instr.index) {
+                    return false;
+                }
+                node.operands.assign(stack.end() - instr.index, stack.end());
+                stack.resize(stack.size() - instr.index);
+                break;
+            }
+            if (stack.size() < 2) {
+                return false;
+            }
+            node.right = stack.back();
+            stack.pop_back();
+            node.left = stack.back();
+            stack.pop_back();
+            break;
+        }
+        for (size_t operand : {node.left, node.right}) {
+            if (operand != NONE) {
+                node.depth = std::max(node.depth, m_nodes[operand].depth + 1);
+            }
+        }
+        for (size_t operand : node.operands) {
+            node.depth = std::max(node.depth, m_nodes[operand].depth + 1);
+        }
+        if (node.depth > DEPTH_LIMIT) {
+            return false;
+        }
+        stack.push_back(m_nodes.size());
+        m_nodes.push_back(node);
+    }
+    if (stack.size() != 1) {
+        return false;
+    }
+    m_root = stack.back();
+    return true;
+}
+
+size_t
+Optimizer::add_const(double value)
+{
+    Instruction instr{OpCode::Const};
+    instr.value = value;
+    m_nodes.push_back(Node{instr});
+    return m_nodes.size() - 1;
+}
+
+bool
+Optimizer::is_const(size_t node) const
+{
+    return m_nodes[node].instr.code == OpCode::Const;
+}
+
+double
+Optimizer::const_value(size_t node) const
+{
+    return m_nodes[node].instr.value;
+}
+
+// returns the node that replaces the given one
+size_t
+Optimizer::simplify(size_t node)
+{
+    if (m_nodes[node].right != NONE) {
+        m_nodes[node].right = simplify(m_nodes[node].right);
+    }
+    if (m_nodes[node].left != NONE) {
+        m_nodes[node].left = simplify(m_nodes[node].left);
+    }
+    for (size_t i = 0; i < m_nodes[node].operands.size(); ++i) {
+        size_t operand = simplify(m_nodes[node].operands[i]);
+        m_nodes[node].operands[i] = operand;
+    }
+    const Node cur = m_nodes[node];     // copy, adding nodes will invalidate references
+    switch (cur.instr.code) {
+    case OpCode::Load:
+        if (m_variables.is_constant(cur.instr.index)) {
+            return add_const(m_variables.get(cur.instr.index));
+        }
+        return node;
+    case OpCode::Call:
+        if (is_const(cur.right)
+         && !cur.instr.function->depends_on_context()) {
+            EvalFrame frame(*m_evalContext);
+            return add_const(cur.instr.function->eval(const_value(cur.right), &frame));
+        }
+        return node;
+    case OpCode::CallN:
+        if (std::all_of(cur.operands.begin(), cur.operands.end(), [this] (size_t operand) { return is_const(operand); })
+         && !cur.instr.function->depends_on_context()) {
+            std::vector<double> args;
+            for (size_t operand : cur.operands) {
+                args.push_back(const_value(operand));
+            }
+            EvalFrame frame(*m_evalContext);
+            return add_const(cur.instr.function->eval_args(args, &frame));
+        }
+        return node;
+    case OpCode::Neg:
+        if (is_const(cur.right)) {
+            return add_const(-const_value(cur.right));
+        }
+        if (m_nodes[cur.right].instr.code == OpCode::Neg) {
+            return m_nodes[cur.right].right;    // --x
+        }
+        return node;
+    case OpCode::Const:
+    case OpCode::Param:
+    case OpCode::Dup:
+    case OpCode::PowI:
+    case OpCode::Form:      // evaluates the body, even for constant bounds
+    case OpCode::Reduce:    // the lists may change
+        return node;
+    default:
+        break;
+    }
+    // binary
+    if (is_const(cur.left) && is_const(cur.right)) {
+        return add_const(Program::apply(cur.instr.code, const_value(cur.left), const_value(cur.right)));
+    }
+    const Node right = m_nodes[cur.right];
+    if (right.instr.code == OpCode::Neg
+     && (cur.instr.code == OpCode::Add || cur.instr.code == OpCode::Sub)) {   // a + -b, a - -b
+        Node replace{cur};
+        replace.instr.code = cur.instr.code == OpCode::Add ? OpCode::Sub : OpCode::Add;
+        replace.right = right.right;
+        m_nodes.push_back(replace);
+        return m_nodes.size() - 1;
+    }
+    if (cur.instr.code == OpCode::Div && is_const(cur.right)) {
+        int exp;
+        double divisor = const_value(cur.right);
+        double reciprocal = 1.0 / divisor;
+        if (std::abs(std::frexp(divisor, &exp)) == 0.5
+         && std::isnormal(reciprocal)) {     // the reciprocal is exact, so is the product
+            Node replace{cur};
+            replace.instr.code = OpCode::Mul;
+            replace.right = add_const(reciprocal);
+            m_nodes.push_back(replace);
+            return m_nodes.size() - 1;
+        }
+    }
+    if (cur.instr.code == OpCode::Pow && is_const(cur.right)) {
+        return simplify_pow(node);
+    }
+    return node;
+}
+
+size_t
+Optimizer::simplify_pow(size_t node)
+{
+    const Node cur = m_nodes[node];
+    double exponent = const_value(cur.right);
+    if (exponent != std::trunc(exponent)
+     || std::abs(exponent) > POWI_LIMIT) {
+        return node;
+    }
+    if (exponent == 0.0) {
+        return add_const(1.0);      // as pow does even for nan
+    }
+    if (exponent == 1.0) {
+        return cur.left;
+    }
+    Node replace{Instruction{OpCode::PowI}};
+    replace.instr.value = exponent;
+    replace.right = cur.left;
+    m_nodes.push_back(replace);
+    return m_nodes.size() - 1;
+}
+
+// append the code for the tree at node,
+//   small powers use the value from the stack by Dup
+void
+Optimizer::emit(size_t node, const PtrProgram& from, Program& to)
+{
+    const Node& cur = m_nodes[node];
+    if (cur.left != NONE) {
+        emit(cur.left, from, to);
+    }
+    if (cur.right != NONE) {
+        emit(cur.right, from, to);
+    }
+    for (size_t operand : cur.operands) {
+        emit(operand, from, to);
+    }
+    switch (cur.instr.code) {
+    case OpCode::Const:
+        to.add_const(cur.instr.value);
+        break;
+    case OpCode::Load:
+        to.add_load(cur.instr.index);
+        break;
+    case OpCode::Param:
+        to.add_param(cur.instr.index);
+        break;
+    case OpCode::Call:
+        to.add_call(from->find_function(cur.instr.function));
+        break;
+    case OpCode::CallN:
+        to.add_call(from->find_function(cur.instr.function), cur.instr.index);
+        break;
+    case OpCode::Form:
+        to.add_form(from->find_form(cur.instr.form));
+        break;
+    case OpCode::Reduce:
+        to.add_reduction(from->find_reduction(cur.instr.reduction));
+        break;
+    case OpCode::PowI:
+        if (cur.instr.value == 2.0) {           // x*x
+            to.add_op(OpCode::Dup);
+            to.add_op(OpCode::Mul);
+        }
+        else if (cur.instr.value == 3.0) {      // x*x*x
+            to.add_op(OpCode::Dup);
+            to.add_op(OpCode::Dup);
+            to.add_op(OpCode::Mul);
+            to.add_op(OpCode::Mul);
+        }
+        else if (cur.instr.value == 4.0) {      // (x*x)*(x*x)
+            to.add_op(OpCode::Dup);
+            to.add_op(OpCode::Mul);
+            to.add_op(OpCode::Dup);
+            to.add_op(OpCode::Mul);
+        }
+        else {
+            to.add_powi(static_cast<int>(cur.instr.value));
+        }
+        break;
+    default:
+        to.add_op(cur.instr.code);
+        break;
+    }
+}
@@ -0,0 +1,76 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "Program.hpp"
+#include "VariableStore.hpp"
+
+class BaseEval;
+
+/*
+ * rewrite a compiled program to do less work on each evaluation:
+ *   - fold constant parts, including variables marked constant
+ *     and functions that do not depend on the context,
+ *   - small integral powers become multiplications,
+ *   - division by a power of two becomes a multiplication,
+ *   - double negations are removed.
+ *   Results are the same as for the original program,
+ *   except integral powers above 2, that may differ in the last place.
+ */
+class Optimizer
+{
+public:
+    Optimizer(BaseEval* evalContext, const VariableStore& variables);
+    explicit Optimizer(const Optimizer& orig) = delete;
+    virtual ~Optimizer() = default;
+
+    PtrProgram optimize(const PtrProgram& program);
+
+    // exponents up to this are done by multiplication
+    static constexpr int POWI_LIMIT{64};
+    // the tree is processed recursively, so deeper programs are kept as they are
+    static constexpr size_t DEPTH_LIMIT{1000};
+private:
+    static constexpr size_t NONE{static_cast<size_t>(-1)};
+    // the program as tree, as this allows to look at the operands
+    struct Node
+    {
+        Instruction instr;
+        size_t left{NONE};      // binary only
+        size_t right{NONE};     // operand for unary
+        std::vector<size_t> operands{}; // CallN only
+        size_t depth{1};
+    };
+
+    bool build(const PtrProgram& program);
+    size_t simplify(size_t node);
+    size_t simplify_pow(size_t node);
+    size_t add_const(double value);
+    bool is_const(size_t node) const;
+    double const_value(size_t node) const;
+    void emit(size_t node, const PtrProgram& from, Program& to);
+
+    BaseEval* m_evalContext;
+    const VariableStore& m_variables;
+    std::vector<Node> m_nodes;
+    size_t m_root{NONE};
+};
@@ -19,7 +19,8 @@
 #include <stdio.h>
 #include <cstdint>
 #include <string>
-#include <sstream>
+#include <charconv>
+#include <locale>
 #include <psc_i18n.hpp>
 #include <psc_format.hpp>
 
@@ -73,38 +74,15 @@ OutputForm::get_name()
 }
 
 bool
-OutputForm::parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const
-{
-	try {
-        //std::cout << "OutputForm::parse rem \"" << remain << "\"" << std::endl;
-        if (remain.size() >= 2 && remain.substr(0, 2) == "0x") {
-            // still have to rely on this as hexes are not recognized
-    		value = std::stod(remain, offs);	// c++ way ;), honors local, parses hex (prefix 0x), still no thousands separator
-            //std::cout << "used stod val " << value << " offs " << *offs << std::endl;
-        }
-        else {
-            std::stringstream ins(remain);
-            ins.imbue(std::locale(""));
-            ins >> value;
-            if (ins.fail()) {
-                std::cout << "used ins failed " << std::endl;
-                *offs = 0;
-                return false;
-            }
-            if (ins.tellg() == std::streamoff(-1)) { // end of stream ?
-                *offs = remain.size();
-            }
-            else {
-                *offs = ins.tellg();
-            }
-            //std::cout << "used ins val " << value << " offs " << *offs << std::endl;
-        }
-		return true;
-	}
-	catch (const std::invalid_argument& ex) {
-        std::cout << "Invalid argument parsing num " << ex.what() << std::endl;
-	}
-	return false;
+OutputForm::parse(std::string_view remain, double& value, std::string::size_type* offs) const
+{
+    if (remain.starts_with("0x")) {     // hex including floating point
+        const char* start = remain.data();
+        auto [ptr, ec] = std::from_chars(start + 2, start + remain.size(), value, std::chars_format::hex);
+        *offs = ec == std::errc() ? static_cast<std::string::size_type>(ptr - start) : 0;
+        return ec == std::errc();
+    }
+    return parse_decimal(remain, value, offs);
 }
 
 OutformHex::OutformHex()
@@ -135,19 +113,19 @@ OutformOctal::format(double val)
 // for symetric input output processing
 //   allow parsing octals with 010 = 8 (decimal) that might be unexpected in other cases
 bool
-OutformOctal::parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const
+OutformOctal::parse(std::string_view remain, double& value, std::string::size_type* offs) const
 {
-    //std::stod, std::stol, ...
-    std::string::size_type fconv{}, iconv = -1;
+    std::string::size_type fconv{}, iconv{};
     double fval;
-    OutputForm::parse(remain, fval, &fconv);
-	int64_t lout = 0l;
-	try {
-		lout = std::stoll(remain, &iconv, 8);	// c++ way
-	}
-	catch (const std::invalid_argument& ex) {
-        std::cout << "Invalid argument parsing octal " << ex.what() << std::endl;
-	}
+    if (!OutputForm::parse(remain, fval, &fconv)) {
+        fconv = 0;
+    }
+    const char* start = remain.data();
+    int64_t lout{};
+    auto [ptr, ec] = std::from_chars(start, start + remain.size(), lout, 8);
+    if (ec == std::errc()) {
+        iconv = static_cast<std::string::size_type>(ptr - start);
+    }
     //std::cout << "OutformOctal::parse fconv " << fconv << " iconv " << iconv << std::endl;
     if (fconv > iconv) { // if floating conversion length is bigger this seems to be a floating point number
         *offs = fconv;
@@ -55,7 +55,7 @@ public:
     Glib::ustring get_name() override;
     virtual Glib::ustring format(double val) = 0;
 
-    virtual bool parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const override;
+    virtual bool parse(std::string_view remain, double& value, std::string::size_type* offs) const override;
 protected:
     OutputForm(const char* id, const char* name);
 private:
@@ -77,7 +77,7 @@ public:
     OutformOctal();
 
     Glib::ustring format(double val) override;
-    virtual bool parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const override;
+    virtual bool parse(std::string_view remain, double& value, std::string::size_type* offs) const override;
 };
 
 class OutformHexFp : public OutputForm {
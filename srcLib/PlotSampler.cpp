@@ -0,0 +1,490 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <future>
+#include <limits>
+#include <iterator>
+#include <span>
+
+#include "PlotSampler.hpp"
+#include "EvalFrame.hpp"
+#include "UserFunction.hpp"
+#include "BoundForm.hpp"
+#include "ListReduction.hpp"
+
+namespace {
+
+std::vector<double>
+grid(double min, double max, size_t count)
+{
+    count = std::max(count, size_t{2});
+    double step = (max - min) / static_cast<double>(count - 1);
+    std::vector<double> x(count);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = min + step * static_cast<double>(i);
+    }
+    x.back() = max;     // avoid a gap by rounding
+    return x;
+}
+
+// range of the finite values without the outer 5%,
+//   so a pole e.g. of 1/x won't flatten the rest
+double
+y_scale(const std::vector<double>& y)
+{
+    std::vector<double> finite;
+    std::copy_if(y.begin(), y.end(), std::back_inserter(finite),
+                 [] (double val) { return std::isfinite(val); });
+    if (finite.size() < 2) {
+        return 1.0;
+    }
+    auto low = finite.begin() + static_cast<std::ptrdiff_t>(finite.size() / 20);
+    auto high = finite.end() - 1 - static_cast<std::ptrdiff_t>(finite.size() / 20);
+    std::nth_element(finite.begin(), low, finite.end());
+    double lowVal = *low;
+    std::nth_element(finite.begin(), high, finite.end());
+    double scale = *high - lowVal;
+    return scale > 0.0 ? scale : 1.0;
+}
+
+// run task on a own thread, unlike std::async the future
+//   won't wait on destruction, ready is called when the result is set
+template <typename Task>
+std::future<Samples>
+launch(Task&& task, std::function<void()> ready)
+{
+    auto result = std::make_shared<std::promise<Samples>>();
+    auto future = result->get_future();
+    std::thread(
+        [task = std::forward<Task>(task), result, ready = std::move(ready)] () mutable {
+            try {
+                result->set_value(task());
+            }
+            catch (...) {
+                result->set_exception(std::current_exception());
+            }
+            if (ready) {
+                ready();
+            }
+        }).detach();
+    return future;
+}
+
+// distance of the midpoint from the chord relative to scale,
+//   if just some points are finite the border of the domain is located
+double
+deviation(double left, double mid, double right, double scale)
+{
+    int finite = std::isfinite(left) + std::isfinite(mid) + std::isfinite(right);
+    if (finite == 3) {
+        return std::abs(mid - (left + right) / 2.0) / scale;
+    }
+    return finite == 0 ? 0.0 : std::numeric_limits<double>::infinity();
+}
+
+// a narrow spike between the points is found by the enclosure
+//   reaching far beyond them, the dependency of the interval evaluation
+//   overestimates a bit so just a large excess counts
+double
+hidden(const Interval& enclosure, double left, double mid, double right, double scale)
+{
+    if (!enclosure.is_bounded()
+     || !std::isfinite(left + mid + right)) {
+        return 0.0;     // e.g. a pole, that is found by the deviation
+    }
+    double low = std::min({left, mid, right});
+    double high = std::max({left, mid, right});
+    double excess = std::max(enclosure.hi - high, low - enclosure.lo) / scale;
+    return excess > PlotSampler::ADAPTIVE_JUMP ? excess : 0.0;
+}
+
+}
+
+bool
+Samples::contains(double at) const
+{
+    return !x.empty()
+        && at >= x.front()
+        && at <= x.back();
+}
+
+double
+Samples::interpolate(double at) const
+{
+    auto upper = std::lower_bound(x.begin(), x.end(), at);
+    auto i = static_cast<size_t>(std::distance(x.begin(), upper));
+    if (i >= x.size()) {
+        return y.back();
+    }
+    if (x[i] == at
+     || i == 0) {
+        return y[i];
+    }
+    double t = (at - x[i - 1]) / (x[i] - x[i - 1]);
+    return y[i - 1] + t * (y[i] - y[i - 1]);
+}
+
+PlotSampler::PlotSampler(BaseEval& context, const PtrProgram& program, bool derivative)
+: m_context{context}
+, m_program{program}
+, m_derivative{derivative}
+{
+}
+
+// the frames are created here, as they read the variables of the context
+std::shared_ptr<PlotSampler::Frames>
+PlotSampler::create_frames(size_t count)
+{
+    auto frames = std::make_shared<Frames>();
+    if (count == 0) {
+        count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (size_t t = 0; t < count; ++t) {
+        frames->emplace_back(std::make_unique<EvalFrame>(m_context));
+        frames->back()->detach();
+    }
+    return frames;
+}
+
+// split x into chunks that are evaluated in parallel, one frame per chunk
+std::vector<double>
+PlotSampler::evaluate(Frames& frames, const Program& program, bool derivative
+                    , const std::vector<double>& x)
+{
+    std::vector<double> y(x.size());
+    auto eval_chunk = [&program, &x, &y, derivative] (EvalFrame& frame, size_t start, size_t len) {
+        if (derivative) {
+            for (size_t i = start; i < start + len; ++i) {
+                Dual arg(x[i], 1.0);
+                y[i] = frame.eval_dual(program, std::span<const Dual>(&arg, 1)).der;
+            }
+        }
+        else {
+            frame.eval_batch(program
+                           , std::span<const double>(x).subspan(start, len)
+                           , std::span<double>(y).subspan(start, len));
+        }
+    };
+    size_t chunks = std::clamp(x.size() / CHUNK_MIN, size_t{1}, frames.size());
+    if (chunks == 1) {
+        eval_chunk(*frames[0], 0, x.size());
+        return y;
+    }
+    size_t chunkSize = (x.size() + chunks - 1) / chunks;
+    std::vector<std::future<void>> parts;
+    for (size_t start = 0; start < x.size(); start += chunkSize) {
+        size_t len = std::min(chunkSize, x.size() - start);
+        auto& frame = frames[parts.size()];
+        parts.push_back(std::async(std::launch::async,
+            [&frame, &eval_chunk, start, len] {
+                eval_chunk(*frame, start, len);
+            }));
+    }
+    for (auto& part : parts) {
+        part.get();     // rethrows, the remaining parts are waited for on destruction
+    }
+    return y;
+}
+
+std::future<Samples>
+PlotSampler::sample(double min, double max, size_t count)
+{
+    return std::async(std::launch::async,
+        [frames = create_frames(), program = m_program, derivative = m_derivative, min, max, count] {
+            Samples samples;
+            samples.x = grid(min, max, count);
+            samples.y = evaluate(*frames, *program, derivative, samples.x);
+            return samples;
+        });
+}
+
+std::future<Samples>
+PlotSampler::sample_adaptive(double min, double max, size_t budget, std::function<void()> ready)
+{
+    return launch(
+        [frames = create_frames(), program = m_program, derivative = m_derivative, min, max, budget
+       , cancel = m_cancel] {
+            return adaptive(*frames, *program, derivative, min, max, budget, *cancel);
+        }, std::move(ready));
+}
+
+// the tasks keep the flag they were started with
+void
+PlotSampler::cancel()
+{
+    m_cancel->store(true);
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+}
+
+Samples
+PlotSampler::adaptive(Frames& frames, const Program& program, bool derivative
+                    , double min, double max, size_t budget, const std::atomic<bool>& cancelled)
+{
+    budget = std::max(budget, size_t{2});
+    size_t start = std::min(std::max(budget / ADAPTIVE_START, ADAPTIVE_GRID_MIN), budget);
+    Samples samples;
+    samples.x = grid(min, max, start);
+    samples.y = evaluate(frames, program, derivative, samples.x);
+    refine(frames, program, derivative, samples, budget - start, cancelled);
+    return samples;
+}
+
+// the tiles are aligned to multiples of their width,
+//   so they stay the same while panning
+std::future<Samples>
+PlotSampler::sample_tiles(double min, double max, size_t budget, std::function<void()> ready)
+{
+    double range = max - min;
+    if (!(range > 0.0)
+     || !std::isfinite(range)) {
+        return sample_adaptive(min, max, budget, std::move(ready));
+    }
+    int level = static_cast<int>(std::floor(std::log2(range / static_cast<double>(TILES_PER_VIEW))));
+    double width = std::ldexp(1.0, level);
+    double first = std::floor(min / width);
+    double last = std::ceil(max / width);
+    if (std::max(std::abs(first), std::abs(last)) > TILE_INDEX_MAX) {
+        return sample_adaptive(min, max, budget, std::move(ready));
+    }
+    check_inputs();
+    auto tileBudget = static_cast<size_t>(static_cast<double>(budget) * width / range);
+    tileBudget = std::max(tileBudget, ADAPTIVE_GRID_MIN * 2);
+    struct Pending
+    {
+        std::shared_ptr<const Samples> cached;
+        std::future<Samples> sampled;
+        TileKey key;
+    };
+    std::vector<Pending> tiles;
+    std::lock_guard<std::mutex> lock(m_tileMutex);
+    for (auto index = static_cast<int64_t>(first); index < static_cast<int64_t>(last); ++index) {
+        TileKey key{m_version, level, index};
+        auto cached = m_tiles.find(key);
+        if (cached != m_tiles.end()
+         && cached->second.budget >= tileBudget) {
+            tiles.push_back(Pending{cached->second.samples, std::future<Samples>(), key});
+            continue;
+        }
+        double tileMin = static_cast<double>(index) * width;
+        // a own frame per tile, so the missing tiles are sampled in parallel
+        auto frames = create_frames(1);
+        tiles.push_back(Pending{nullptr
+                , std::async(std::launch::async,
+                    [frames, program = m_program, derivative = m_derivative, tileMin, width, tileBudget
+                   , cancel = m_cancel] {
+                        return adaptive(*frames, *program, derivative, tileMin, tileMin + width, tileBudget, *cancel);
+                    })
+                , key});
+    }
+    return launch(
+        [this, tiles = std::move(tiles), tileBudget, cancel = m_cancel] () mutable {
+            Samples samples;
+            for (auto& tile : tiles) {
+                if (!tile.cached) {
+                    auto sampled = std::make_shared<const Samples>(tile.sampled.get());
+                    std::lock_guard<std::mutex> lock(m_tileMutex);
+                    if (tile.key.version == m_version       // skip if the inputs changed meanwhile
+                     && !*cancel) {                         //   or the tile is incomplete
+                        m_tiles[tile.key] = Tile{tileBudget, sampled};
+                    }
+                    tile.cached = sampled;
+                }
+                auto& x = tile.cached->x;
+                auto& y = tile.cached->y;
+                size_t skip = !samples.x.empty() && samples.x.back() == x.front() ? 1 : 0;   // shared border
+                samples.x.insert(samples.x.end(), x.begin() + static_cast<std::ptrdiff_t>(skip), x.end());
+                samples.y.insert(samples.y.end(), y.begin() + static_cast<std::ptrdiff_t>(skip), y.end());
+            }
+            return samples;
+        }, std::move(ready));
+}
+
+// the tiles are valid as long as the variables used by the program
+//   and the angle unit keep their values
+void
+PlotSampler::check_inputs()
+{
+    std::vector<double> inputs;
+    collect_inputs(*m_program, inputs);
+    inputs.push_back(m_context.get_right_angle());
+    auto same = [] (double l, double r) {
+        return l == r || (std::isnan(l) && std::isnan(r));
+    };
+    if (!std::equal(inputs.begin(), inputs.end(), m_inputs.begin(), m_inputs.end(), same)) {
+        std::lock_guard<std::mutex> lock(m_tileMutex);
+        m_inputs = std::move(inputs);
+        ++m_version;
+        m_tiles.clear();
+    }
+}
+
+// the variables and lists used by program, also within the bodies
+//   of forms, reductions and user functions,
+//   a list is preceded by its size, so the inputs stay aligned
+void
+PlotSampler::collect_inputs(const Program& program, std::vector<double>& inputs)
+{
+    auto& variables = m_context.get_variables();
+    auto add_slot = [&] (size_t slot) {
+        if (slot < variables.size()
+         && variables.is_list(slot)) {
+            auto list = variables.get_list(slot);
+            inputs.push_back(static_cast<double>(list.size()));
+            inputs.insert(inputs.end(), list.begin(), list.end());
+        }
+        else {
+            inputs.push_back(slot < variables.size() && variables.is_defined(slot)
+                             ? variables.get(slot)
+                             : std::numeric_limits<double>::quiet_NaN());
+        }
+    };
+    for (auto& instr : program.get_code()) {
+        switch (instr.code) {
+        case OpCode::Load:
+            add_slot(instr.index);
+            break;
+        case OpCode::Call:
+        case OpCode::CallN:
+            if (auto userFunction = dynamic_cast<UserFunction*>(instr.function)) {
+                collect_inputs(*userFunction->get_body(), inputs);
+            }
+            break;
+        case OpCode::Form:
+            collect_inputs(*instr.form->get_body(), inputs);
+            break;
+        case OpCode::Reduce:
+            for (auto& expression : instr.reduction->get_expressions()) {
+                collect_inputs(*expression, inputs);
+            }
+            for (auto& input : instr.reduction->get_inputs()) {
+                if (input.literal) {
+                    for (auto& element : input.elements) {
+                        collect_inputs(*element, inputs);
+                    }
+                }
+                else {
+                    add_slot(input.slot);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// halve the intervals level by level, so each level is evaluated as one batch,
+//   the intervals that deviate most are preferred
+void
+PlotSampler::refine(Frames& frames, const Program& program, bool derivative
+                  , Samples& samples, size_t budget, const std::atomic<bool>& cancelled)
+{
+    struct Segment
+    {
+        size_t left;    // index of the left point
+        double score;
+        Interval enclosure;
+    };
+    double scale = y_scale(samples.y);
+    double finest = std::ldexp((samples.x.back() - samples.x.front())
+                               / static_cast<double>(samples.x.size() - 1), -ADAPTIVE_LEVELS);
+    std::vector<Segment> active;
+    for (size_t i = 0; i + 1 < samples.x.size(); ++i) {
+        active.push_back(Segment{i, std::numeric_limits<double>::infinity(), Interval()});
+    }
+    std::vector<double> jumps;
+    while (!active.empty()
+        && budget > 0
+        && !cancelled) {
+        // a enclosure may prove a segment flat or outside the domain, without sampling it,
+        //   there is none for the derivative
+        for (auto& segment : active) {
+            Interval range(samples.x[segment.left], samples.x[segment.left + 1]);
+            segment.enclosure = derivative
+                                ? Interval::entire()
+                                : frames[0]->eval_interval(program, std::span<const Interval>(&range, 1));
+        }
+        std::erase_if(active, [scale] (const Segment& segment) {
+            return segment.enclosure.is_empty()
+                || (segment.enclosure.is_bounded()
+                 && segment.enclosure.width() <= ADAPTIVE_TOLERANCE * scale);
+        });
+        size_t spend = (budget + 1) / 2;
+        if (active.size() > spend) {
+            std::nth_element(active.begin(), active.begin() + static_cast<std::ptrdiff_t>(spend), active.end(),
+                [] (const Segment& l, const Segment& r) { return l.score > r.score; });
+            active.resize(spend);
+            std::sort(active.begin(), active.end(),
+                [] (const Segment& l, const Segment& r) { return l.left < r.left; });
+        }
+        std::vector<double> midX;
+        midX.reserve(active.size());
+        for (auto& interval : active) {
+            midX.push_back((samples.x[interval.left] + samples.x[interval.left + 1]) / 2.0);
+        }
+        auto midY = evaluate(frames, program, derivative, midX);
+        budget -= midX.size();
+        Samples merged;
+        merged.x.reserve(samples.x.size() + midX.size());
+        merged.y.reserve(samples.y.size() + midY.size());
+        std::vector<Segment> next;
+        size_t k = 0;
+        for (size_t i = 0; i < samples.x.size(); ++i) {
+            merged.x.push_back(samples.x[i]);
+            merged.y.push_back(samples.y[i]);
+            if (k < active.size()
+             && active[k].left == i) {
+                size_t left = merged.x.size() - 1;
+                merged.x.push_back(midX[k]);
+                merged.y.push_back(midY[k]);
+                double yl = samples.y[i];
+                double yr = samples.y[i + 1];
+                double dev = deviation(yl, midY[k], yr, scale);
+                double score = std::max(dev, hidden(active[k].enclosure, yl, midY[k], yr, scale));
+                if (score > ADAPTIVE_TOLERANCE) {
+                    if (midX[k] - samples.x[i] > finest) {
+                        next.push_back(Segment{left, score, Interval()});
+                        next.push_back(Segment{left + 1, score, Interval()});
+                    }
+                    else if (dev > ADAPTIVE_JUMP
+                          && std::isfinite(dev)     // a non finite point breaks the curve already
+                          && dev * scale > std::abs(yr - yl) / 3.0) {  // steep but continuous stays below
+                        jumps.push_back(std::abs(midY[k] - yl) > std::abs(yr - midY[k])
+                                        ? (samples.x[i] + midX[k]) / 2.0
+                                        : (midX[k] + samples.x[i + 1]) / 2.0);
+                    }
+                }
+                ++k;
+            }
+        }
+        samples = std::move(merged);
+        active = std::move(next);
+    }
+    if (!jumps.empty()) {
+        std::sort(jumps.begin(), jumps.end());
+        for (auto jump = jumps.rbegin(); jump != jumps.rend(); ++jump) {
+            auto at = std::lower_bound(samples.x.begin(), samples.x.end(), *jump);
+            auto offs = std::distance(samples.x.begin(), at);
+            samples.x.insert(at, *jump);
+            samples.y.insert(samples.y.begin() + offs, std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+}
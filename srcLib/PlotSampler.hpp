@@ -0,0 +1,143 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <functional>
+
+#include "BaseEval.hpp"
+#include "Program.hpp"
+
+class EvalFrame;
+
+/*
+ * points of a function of x, sorted by x
+ */
+struct Samples
+{
+    std::vector<double> x;
+    std::vector<double> y;
+
+    bool contains(double at) const;
+    // linear between the neighbouring samples
+    double interpolate(double at) const;
+};
+
+/*
+ * sample a compiled function of one parameter x,
+ *   the points are split into chunks that are evaluated
+ *   in parallel, each with a detached EvalFrame.
+ */
+class PlotSampler
+{
+public:
+    // derivative samples f'(x) instead of f(x), by dual numbers
+    PlotSampler(BaseEval& context, const PtrProgram& program, bool derivative = false);
+    explicit PlotSampler(const PlotSampler& orig) = delete;
+    virtual ~PlotSampler() = default;
+
+    // count points evenly spaced over [min, max],
+    //   call on the thread that owns the context,
+    //   the result gets ready when all chunks are done
+    //   (rethrows e.g. a EvalError from evaluation).
+    std::future<Samples> sample(double min, double max, size_t count);
+    // at most budget points over [min, max], starting with a coarse grid
+    //   intervals are halved where the curve bends or jumps,
+    //   or where the interval enclosure hints to a narrow spike,
+    //   intervals enclosed within the tolerance are left as they are,
+    //   each level uses at most half of the remaining budget, so the
+    //   intervals that deviate most still get refined deeply,
+    //   a jump that remains at the finest width is marked by a NaN point.
+    //   ready is called by the sampling task once the result is ready,
+    //   the result won't wait for the task on destruction.
+    std::future<Samples> sample_adaptive(double min, double max, size_t budget
+                                       , std::function<void()> ready = {});
+    // as sample_adaptive, but by tiles of a power of 2 width, about TILES_PER_VIEW
+    //   for [min, max], the sampled tiles are kept, so overlapping ranges
+    //   e.g. on panning just sample the tiles that are new.
+    //   The tiles are dropped when a variable or list used by the program,
+    //   also within forms, reductions or user functions, or the angle unit changes.
+    //   The sampler has to outlive the result.
+    std::future<Samples> sample_tiles(double min, double max, size_t budget
+                                    , std::function<void()> ready = {});
+    // the running samplings end early, their results are incomplete
+    //   and not kept as tiles, the following ones are not affected
+    void cancel();
+
+    // points evaluated by one task, smaller ranges are done by one
+    static constexpr size_t CHUNK_MIN{1024};
+    // the coarse grid takes this fraction of the budget
+    static constexpr size_t ADAPTIVE_START{8};
+    static constexpr size_t ADAPTIVE_GRID_MIN{16};
+    // deviation of a midpoint from the chord, relative to the range of y,
+    //   that needs refinement, about a pixel on a large drawing
+    static constexpr double ADAPTIVE_TOLERANCE{1.0e-3};
+    // deviation at the finest width that is shown as discontinuity
+    static constexpr double ADAPTIVE_JUMP{0.1};
+    // the coarse grid intervals are halved at most this often
+    static constexpr int ADAPTIVE_LEVELS{10};
+    static constexpr size_t TILES_PER_VIEW{8};
+    // beyond this the tile index is no longer exact
+    static constexpr double TILE_INDEX_MAX{9.0e15};
+private:
+    using Frames = std::vector<std::unique_ptr<EvalFrame>>;
+    using Cancel = std::shared_ptr<std::atomic<bool>>;
+    // count 0 creates one per hardware thread
+    std::shared_ptr<Frames> create_frames(size_t count = 0);
+    static std::vector<double> evaluate(Frames& frames, const Program& program, bool derivative
+                                      , const std::vector<double>& x);
+    static Samples adaptive(Frames& frames, const Program& program, bool derivative
+                          , double min, double max, size_t budget, const std::atomic<bool>& cancelled);
+    static void refine(Frames& frames, const Program& program, bool derivative
+                     , Samples& samples, size_t budget, const std::atomic<bool>& cancelled);
+    void check_inputs();
+    void collect_inputs(const Program& program, std::vector<double>& inputs);
+
+    struct TileKey
+    {
+        uint64_t version;
+        int level;          // the width is 2^level
+        int64_t index;      // the start is index * width
+
+        bool operator<(const TileKey& other) const
+        {
+            return std::tie(version, level, index) < std::tie(other.version, other.level, other.index);
+        }
+    };
+    struct Tile
+    {
+        size_t budget;
+        std::shared_ptr<const Samples> samples;
+    };
+
+    BaseEval& m_context;
+    PtrProgram m_program;
+    bool m_derivative;
+    std::mutex m_tileMutex;     // the tiles are added by the sampling task
+    std::map<TileKey, Tile> m_tiles;
+    uint64_t m_version{};
+    std::vector<double> m_inputs;
+    Cancel m_cancel{std::make_shared<std::atomic<bool>>(false)};
+};
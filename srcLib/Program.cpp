@@ -0,0 +1,238 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4; coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Program.hpp"
+#include "BoundForm.hpp"
+#include "ListReduction.hpp"
+
+void
+Program::add_const(double value)
+{
+    Instruction instr{OpCode::Const};
+    instr.value = value;
+    push(instr);
+}
+
+void
+Program::add_load(size_t slot)
+{
+    Instruction instr{OpCode::Load};
+    instr.index = static_cast<uint32_t>(slot);
+    push(instr);
+}
+
+void
+Program::add_param(size_t index)
+{
+    Instruction instr{OpCode::Param};
+    instr.index = static_cast<uint32_t>(index);
+    push(instr);
+}
+
+void
+Program::add_call(const std::shared_ptr<Function>& function, size_t arity)
+{
+    Instruction instr{arity > 1 ? OpCode::CallN : OpCode::Call};
+    instr.index = arity > 1 ? static_cast<uint32_t>(arity) : 0;
+    instr.function = function.get();
+    if (std::find(m_functions.begin(), m_functions.end(), function) == m_functions.end()) {
+        m_functions.push_back(function);
+    }
+    push(instr);
+}
+
+void
+Program::add_op(OpCode code)
+{
+    push(Instruction{code});
+}
+
+void
+Program::add_powi(int exponent)
+{
+    Instruction instr{OpCode::PowI};
+    instr.value = static_cast<double>(exponent);
+    push(instr);
+}
+
+void
+Program::add_form(const std::shared_ptr<BoundForm>& form)
+{
+    Instruction instr{OpCode::Form};
+    instr.form = form.get();
+    m_forms.push_back(form);
+    push(instr);
+}
+
+void
+Program::add_reduction(const std::shared_ptr<ListReduction>& reduction)
+{
+    Instruction instr{OpCode::Reduce};
+    instr.reduction = reduction.get();
+    m_reductions.push_back(reduction);
+    push(instr);
+}
+
+void
+Program::add(const Instruction& instr, const Program& from)
+{
+    if (instr.function
+     && !find_function(instr.function)) {
+        m_functions.push_back(from.find_function(instr.function));
+    }
+    if (instr.form
+     && !find_form(instr.form)) {
+        m_forms.push_back(from.find_form(instr.form));
+    }
+    if (instr.reduction
+     && !find_reduction(instr.reduction)) {
+        m_reductions.push_back(from.find_reduction(instr.reduction));
+    }
+    push(instr);
+}
+
+// the change of stack depth an instruction will cause
+int
+Program::stack_effect(const Instruction& instr)
+{
+    switch (instr.code) {
+    case OpCode::CallN:
+        return 1 - static_cast<int>(instr.index);
+    case OpCode::Const:
+    case OpCode::Load:
+    case OpCode::Param:
+    case OpCode::Dup:
+    case OpCode::Reduce:
+        return 1;
+    case OpCode::Call:
+    case OpCode::Neg:
+    case OpCode::PowI:
+        return 0;
+    default:
+        return -1;  // binary operators and forms consume two, add one
+    }
+}
+
+void
+Program::push(const Instruction& instr)
+{
+    m_code.push_back(instr);
+    m_depth = static_cast<size_t>(static_cast<int>(m_depth) + stack_effect(instr));
+    m_maxDepth = std::max(m_maxDepth, m_depth);
+}
+
+const std::vector<Instruction>&
+Program::get_code() const
+{
+    return m_code;
+}
+
+size_t
+Program::get_max_depth() const
+{
+    return m_maxDepth;
+}
+
+void
+Program::set_param_count(size_t count)
+{
+    m_paramCount = count;
+}
+
+size_t
+Program::get_param_count() const
+{
+    return m_paramCount;
+}
+
+void
+Program::set_assign(size_t slot)
+{
+    m_isAssign = true;
+    m_assign = slot;
+}
+
+void
+Program::set_define(const std::shared_ptr<UserFunction>& function)
+{
+    m_define = function;
+}
+
+const std::shared_ptr<UserFunction>&
+Program::get_define() const
+{
+    return m_define;
+}
+
+void
+Program::set_list(const std::shared_ptr<ListReduction>& list)
+{
+    m_list = list;
+}
+
+const std::shared_ptr<ListReduction>&
+Program::get_list() const
+{
+    return m_list;
+}
+
+bool
+Program::is_assign() const
+{
+    return m_isAssign;
+}
+
+size_t
+Program::get_assign() const
+{
+    return m_assign;
+}
+
+// the shared pointer for a function called by this program
+std::shared_ptr<Function>
+Program::find_function(const Function* function) const
+{
+    auto iter = std::find_if(m_functions.begin(), m_functions.end()
+            , [function] (const std::shared_ptr<Function>& fun) {
+                return fun.get() == function;
+            });
+    return iter != m_functions.end() ? *iter : std::shared_ptr<Function>();
+}
+
+// the shared pointer for a form used by this program
+std::shared_ptr<BoundForm>
+Program::find_form(const BoundForm* form) const
+{
+    auto iter = std::find_if(m_forms.begin(), m_forms.end()
+            , [form] (const std::shared_ptr<BoundForm>& frm) {
+                return frm.get() == form;
+            });
+    return iter != m_forms.end() ? *iter : std::shared_ptr<BoundForm>();
+}
+
+std::shared_ptr<ListReduction>
+Program::find_reduction(const ListReduction* reduction) const
+{
+    auto iter = std::find_if(m_reductions.begin(), m_reductions.end()
+            , [reduction] (const std::shared_ptr<ListReduction>& red) {
+                return red.get() == reduction;
+            });
+    return iter != m_reductions.end() ? *iter : std::shared_ptr<ListReduction>();
+}
@@ -0,0 +1,171 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glibmm.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+
+#include "Function.hpp"
+
+class BoundForm;
+class UserFunction;
+class ListReduction;
+
+enum class OpCode : uint8_t
+{
+    Const,      // push value
+    Load,       // push variable from slot
+    Param,      // push bound parameter
+    Call,       // replace top of stack by function result
+    CallN,      // replace index arguments on top of stack by function result
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Shl,
+    Shr,
+    And,
+    Or,
+    Neg,
+    Dup,        // push a copy of top of stack
+    PowI,       // raise top of stack to the integral power value
+    Form,       // replace the range bounds on top of stack by the form result
+    Reduce      // push the result of a list reduction
+};
+
+struct Instruction
+{
+    OpCode code;
+    uint32_t index{};           // Load: variable slot, Param: parameter index, CallN: arity
+    double value{};             // Const: value, PowI: exponent
+    Function* function{};       // Call, CallN: kept alive by the owning program
+    BoundForm* form{};          // Form: kept alive by the owning program
+    ListReduction* reduction{}; // Reduce: kept alive by the owning program
+};
+
+/*
+ * flat representation of a parsed expression,
+ *   build by BaseEval::compile, so repeated evaluation
+ *   does not need to walk the token list again.
+ *   Variables are referenced by slots of the VariableStore
+ *   of the compiling BaseEval, so only use it with that.
+ *   Parameters are bound by position on evaluation,
+ *   and will not touch the variables.
+ */
+class Program
+{
+public:
+    Program() = default;
+    explicit Program(const Program& orig) = delete;
+    virtual ~Program() = default;
+
+    void add_const(double value);
+    void add_load(size_t slot);
+    void add_param(size_t index);
+    // arity above 1 adds a CallN
+    void add_call(const std::shared_ptr<Function>& function, size_t arity = 1);
+    void add_op(OpCode code);
+    void add_powi(int exponent);
+    void add_form(const std::shared_ptr<BoundForm>& form);
+    void add_reduction(const std::shared_ptr<ListReduction>& reduction);
+    // a instruction of the program from, e.g. to inline it
+    void add(const Instruction& instr, const Program& from);
+
+    const std::vector<Instruction>& get_code() const;
+    size_t get_max_depth() const;
+    void set_param_count(size_t count);
+    size_t get_param_count() const;
+    void set_assign(size_t slot);
+    bool is_assign() const;
+    size_t get_assign() const;
+    // the evaluation defines the function, instead of computing a value
+    void set_define(const std::shared_ptr<UserFunction>& function);
+    const std::shared_ptr<UserFunction>& get_define() const;
+    // the evaluation assigns the list, instead of a value
+    void set_list(const std::shared_ptr<ListReduction>& list);
+    const std::shared_ptr<ListReduction>& get_list() const;
+    std::shared_ptr<Function> find_function(const Function* function) const;
+    std::shared_ptr<BoundForm> find_form(const BoundForm* form) const;
+    std::shared_ptr<ListReduction> find_reduction(const ListReduction* reduction) const;
+
+    static int stack_effect(const Instruction& instr);
+    // the binary operations, shared by evaluation and constant folding
+    static double apply(OpCode code, double left, double right)
+    {
+        switch (code) {
+        case OpCode::Add:
+            return left + right;
+        case OpCode::Sub:
+            return left - right;
+        case OpCode::Mul:
+            return left * right;
+        case OpCode::Div:
+            return left / right;
+        case OpCode::Mod:
+            return std::fmod(left, right);
+        case OpCode::Pow:
+            return std::pow(left, right);
+        case OpCode::Shl:
+            return static_cast<double>(static_cast<uint64_t>(left) << static_cast<uint64_t>(right));
+        case OpCode::Shr:
+            return static_cast<double>(static_cast<uint64_t>(left) >> static_cast<uint64_t>(right));
+        case OpCode::And:
+            return static_cast<double>(static_cast<uint64_t>(left) & static_cast<uint64_t>(right));
+        case OpCode::Or:
+            return static_cast<double>(static_cast<uint64_t>(left) | static_cast<uint64_t>(right));
+        default:
+            return NAN;     // not binary
+        }
+    }
+    // integral power by squaring
+    static double powi(double base, double exponent)
+    {
+        auto n = static_cast<uint32_t>(std::abs(exponent));
+        double result = 1.0;
+        while (n > 0) {
+            if (n & 1u) {
+                result *= base;
+            }
+            base *= base;
+            n >>= 1;
+        }
+        return exponent < 0.0 ? 1.0 / result : result;
+    }
+private:
+    void push(const Instruction& instr);
+
+    std::vector<Instruction> m_code;
+    std::vector<std::shared_ptr<Function>> m_functions;
+    std::vector<std::shared_ptr<BoundForm>> m_forms;
+    std::vector<std::shared_ptr<ListReduction>> m_reductions;
+    size_t m_depth{};
+    size_t m_maxDepth{};
+    size_t m_paramCount{};
+    bool m_isAssign{false};
+    size_t m_assign{};
+    std::shared_ptr<UserFunction> m_define;
+    std::shared_ptr<ListReduction> m_list;
+};
+
+using PtrProgram = std::shared_ptr<Program>;
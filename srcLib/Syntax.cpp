@@ -18,10 +18,14 @@
 
 #include <iostream>
 #include <cmath>
-#include <stack>
+#include <vector>
+#include <array>
 
 #include "Syntax.hpp"
+#include "Utf8.hpp"
 #include "BaseEval.hpp"
+#include "BoundForm.hpp"
+#include "ListReduction.hpp"
 #include "calcpp_config.h"
 
 Syntax::Syntax(const PtrNumberFormat& numberFormat, const std::shared_ptr<BaseEval>& conversionContext)
@@ -31,246 +35,286 @@ Syntax::Syntax(const PtrNumberFormat& numberFormat, const std::shared_ptr<BaseEv
 }
 
 
-std::list<std::shared_ptr<Token>>
+Ast
 Syntax::parse(Glib::ustring& input)
 {
-	auto tokens = lexing(input);
-	insertNegate(tokens);
-	auto queue = shuntingYard(tokens);
-	return queue;
+    return parse(std::string_view{input.raw()});
 }
 
-// replace Op'-' by negate'-' where its necessary
-//	 allows -- that is no decrement!
-void
-Syntax::insertNegate(std::list<std::shared_ptr<Token>>& tokens)
+Ast
+Syntax::parse(std::string_view input)
 {
-	bool negPossibleOp = true;	// expression may start with sign
-	auto iter = tokens.begin();
-	while (iter != tokens.end()) {
-		auto token = *iter;
-		std::shared_ptr<OpToken> op = std::dynamic_pointer_cast<OpToken>(token);
-		if (negPossibleOp
-		 && op
-		 && (OpAddToken::is_minus(op->get_op()))) {
-			(*iter) = std::make_shared<NegateToken>('-');
-		}
-		std::shared_ptr<AssignToken> assign = std::dynamic_pointer_cast<AssignToken>(token);
-		negPossibleOp = (op && !op->is_right_paren()) && (op.operator bool() || assign.operator bool());
-		++iter;
-	}
+    Ast ast{input};
+    m_input = ast.get_text();
+    m_pos = 0;
+    m_nesting = 0;
+    advance();
+    ast.set_root(parse_statement(ast));
 #   ifdef DEBUG
-        std::cout << "after insertNegate ---------" << std::endl;
-        for (auto token : tokens) {
-            std::cout << type_name<decltype(token)>() << " " << token->show() << std::endl;
-        }
+        std::cout << "parse " << ast.show() << std::endl;
 #   endif
+    return ast;
 }
 
+// read the next token into m_token
+void
+Syntax::advance()
+{
+    size_t start = m_pos;
+    m_hasToken = get_next_token(m_input, m_pos, &m_token);
+    // the token starts behind the skipped spaces
+    size_t len;
+    while (start < m_pos
+        && Utf8::is_space(Utf8::decode(m_input, start, &len))) {
+        start += len;
+    }
+    m_tokenPos = start;
+}
 
-// see https://en.wikipedia.org/wiki/Shunting_yard_algorithm
-std::list<std::shared_ptr<Token>>
-Syntax::shuntingYard(std::list<std::shared_ptr<Token>> tokens)
+// expression or id = expression
+uint32_t
+Syntax::parse_statement(Ast& ast)
 {
-	std::list<std::shared_ptr<Token>> queue;	// queue woud resemble the functions more closely, but later we require a serial access
-	std::stack<std::shared_ptr<Token>> ops;		// stack will resemble the need function more closely
-	while (!tokens.empty()) {
-		// read a token
-		auto token = tokens.front();
-		tokens.pop_front();
-		std::shared_ptr<NumToken> numToken = std::dynamic_pointer_cast<NumToken>(token);
-		if (numToken) {
-			// - a number: put it into the output queue
-			queue.push_back(numToken);
-		}
-		std::shared_ptr<AssignToken> assingToken = std::dynamic_pointer_cast<AssignToken>(token);
-		if (assingToken) {
-			// - a assignment: put it into the output queue
-			queue.push_back(assingToken);
-		}
-		std::shared_ptr<IdToken> idToken = std::dynamic_pointer_cast<IdToken>(token);
-		if (idToken) {
-			auto id = idToken->getId();
-            auto funct = m_conversionContext->getFunction(id);
-			if (funct) {
-				//  - a function: push it onto the operator stack
-				idToken->set_function(true);
-				ops.push(idToken);
-			}
-			else {
-				//  - a identifier: handle like number
-				queue.push_back(idToken);
-			}
-		}
-		std::shared_ptr<OpToken> op1 = std::dynamic_pointer_cast<OpToken>(token);
-		if (op1) {
-			// - an operator o1:
-			while (!ops.empty()) {
-				std::shared_ptr<Token> op2token = ops.top();
-				std::shared_ptr<OpToken> op2 = std::dynamic_pointer_cast<OpToken>(op2token);
-				if (op2) {
-					// there is an operator o2 other than the left parenthesis at the top of the operator stack,
-					// and (o2 has greater precedence than o1
-					// or they have the same precedence and o1 is left-associative)
-					bool is_greater_prece = op2->precedence() > op1->precedence();
-					bool is_same_prece = op2->precedence() == op1->precedence();
-					//std::cout << "op1 " << op1->show()
-					//		  << " op2 " << op2->show()
-					//		  << " greater " << (is_greater_prece ? "yes" : "no")
-					//		  << " same " << (is_same_prece ? "yes" : "no")
-					//	      << std::endl;
-					if (op2->is_left_paren()
-						|| (!is_greater_prece
-							&& (!is_same_prece
-								|| !op1->is_left_assoc()))) {
-                        break;
-					}
-                    // pop o2 from the operator stack into the output queue
-                    ops.pop();
-                    queue.push_back(op2token);
-				}
-				else {
-					break;
-				}
-			}
-            if (!op1->is_right_paren()) {   // don't want paren on stack
-                // push o1 onto the operator stack
-                ops.push(op1);
-            }
-		}
-        // multi parameter fuctions
-		std::shared_ptr<DelimToken> delimToken = std::dynamic_pointer_cast<DelimToken>(token);
-		if (delimToken) {
-            while (!ops.empty()) {
-                //  while the operator at the top of the operator stack is not a left parenthesis:
-				std::shared_ptr<Token> op2token = ops.top();
-				std::shared_ptr<OpToken> op2 = std::dynamic_pointer_cast<OpToken>(op2token);
-				if (op2->is_left_paren()) {
-                    break;
-                }
-                // pop the operator from the operator stack into the output queue
-                ops.pop();
-                queue.push_back(op2);
-            }
-		}
-        op1 = std::dynamic_pointer_cast<OpToken>(token);
-        if (op1 && op1->is_right_paren()) {
-            // a right parenthesis (i.e. ")"):
-            while (true) {
-                // while the operator at the top of the operator stack is not a left parenthesis:
-                //    {assert the operator stack is not empty}
-                //    /* If the stack runs out without finding a left parenthesis, then there are mismatched parentheses. */
-                if (ops.empty()) {
-                    throw EvalError("Missmatched parenthesis");
-                }
-                std::shared_ptr<Token> op2token = ops.top();
-                std::shared_ptr<OpToken> op2 = std::dynamic_pointer_cast<OpToken>(op2token);
-                if (op2 && op2->is_left_paren()) {
-                    break;
-                }
-                //    pop the operator from the operator stack into the output queue
-                ops.pop();
-                queue.push_back(op2token);
-            }
-            //{assert there is a left parenthesis at the top of the operator stack}
-            std::shared_ptr<Token> op2token = ops.top();
-            std::shared_ptr<OpToken> op2 = std::dynamic_pointer_cast<OpToken>(op2token);
-            if (!op2 || !op2->is_left_paren()) {
-                throw EvalError("Expected left parenthesis");
+    uint32_t root = AstNode::NONE;
+    if (m_hasToken
+     && m_token.kind == TokenKind::Id) {
+        size_t start = m_pos;
+        size_t firstPos = m_tokenPos;
+        Token first = m_token;
+        advance();
+        if (m_hasToken
+         && m_token.kind == TokenKind::Assign) {
+            advance();
+            std::array<uint32_t, 2> operands{ast.add(first), parse_expression(ast, 0)};
+            root = ast.add(Token{TokenKind::Assign}, operands);
+        }
+        else if (m_hasToken
+              && m_token.kind == TokenKind::LeftParen) {
+            root = parse_definition(ast, first);
+        }
+        if (root == AstNode::NONE) {
+            // rewind as the id may start a expression
+            m_pos = start;
+            m_tokenPos = firstPos;
+            m_token = first;
+            m_hasToken = true;
+        }
+    }
+    if (root == AstNode::NONE) {
+        root = parse_expression(ast, 0);
+    }
+    if (m_hasToken) {
+        switch (m_token.kind) {
+        case TokenKind::RightParen:
+            throw EvalError("Missmatched parenthesis");
+        case TokenKind::Assign:
+            throw EvalError("Assignment operator only allowed once");
+        default:
+            unexpected();
+        }
+    }
+    return root;
+}
+
+// a function definition f(x; y) = body, expected at (,
+//   NONE if the input is not a definition e.g. for a call f(2)
+uint32_t
+Syntax::parse_definition(Ast& ast, const Token& function)
+{
+    std::vector<Token> params;
+    advance();
+    while (m_hasToken
+        && m_token.kind == TokenKind::Id) {
+        params.push_back(m_token);
+        advance();
+        if (!m_hasToken
+         || m_token.kind != TokenKind::Delim) {
+            break;
+        }
+        advance();
+    }
+    if (params.empty()
+     || !m_hasToken
+     || m_token.kind != TokenKind::RightParen) {
+        return AstNode::NONE;
+    }
+    advance();
+    if (!m_hasToken
+     || m_token.kind != TokenKind::Assign) {
+        return AstNode::NONE;
+    }
+    advance();
+    std::vector<uint32_t> paramNodes;
+    for (auto& param : params) {
+        paramNodes.push_back(ast.add(param));
+    }
+    Token head = function;
+    head.function = true;
+    std::array<uint32_t, 2> operands{ast.add(head, paramNodes), parse_expression(ast, 0)};
+    return ast.add(Token{TokenKind::Assign}, operands);
+}
+
+// see https://en.wikipedia.org/wiki/Operator-precedence_parser#Pratt_parsing
+//   the operand is extended as long as the operators bind at least by minPrecedence
+uint32_t
+Syntax::parse_expression(Ast& ast, int minPrecedence)
+{
+    if (++m_nesting > NESTING_LIMIT) {
+        throw EvalError(Glib::ustring::sprintf("Expression nested deeper than %d", static_cast<int>(NESTING_LIMIT)));
+    }
+    uint32_t left = parse_operand(ast);
+    while (m_hasToken
+        && m_token.kind == TokenKind::Op
+        && m_token.precedence() >= minPrecedence) {
+        Token op = m_token;
+        advance();
+        // left associative operators bind the right side tighter
+        int rightPrecedence = op.is_left_assoc() ? op.precedence() + 1 : op.precedence();
+        std::array<uint32_t, 2> operands{left, parse_expression(ast, rightPrecedence)};
+        left = ast.add(op, operands);
+    }
+    --m_nesting;
+    return left;
+}
+
+uint32_t
+Syntax::parse_operand(Ast& ast)
+{
+    if (!m_hasToken) {
+        throw EvalError(Glib::ustring::sprintf("Missing operand at %d", static_cast<int>(m_pos)));
+    }
+    Token token = m_token;
+    switch (token.kind) {
+    case TokenKind::Number:
+        advance();
+        return ast.add(token);
+    case TokenKind::Id:
+        advance();
+        if (m_conversionContext->lookup_function(ast.get_id(token))
+         || BoundForm::is_form(ast.get_id(token))
+         || ListReduction::is_reduction(ast.get_id(token))) {
+            token.function = true;
+            return parse_call(ast, token);
+        }
+        return ast.add(token);
+    case TokenKind::LeftParen: {
+        advance();
+        uint32_t inner = parse_expression(ast, 0);
+        expect_right_paren();
+        return inner;
+    }
+    case TokenKind::LeftBracket:
+        advance();
+        return parse_list(ast);
+    case TokenKind::Op:
+        if (token.code == OpCode::Sub) {    // allows -- that is no decrement!
+            advance();
+            token.kind = TokenKind::Negate;
+            token.code = OpCode::Neg;
+            std::array<uint32_t, 1> operand{parse_expression(ast, token.precedence())};
+            return ast.add(token, operand);
+        }
+        break;
+    default:
+        break;
+    }
+    unexpected();
+}
+
+// arguments are delimited by ; as , may be decimal separator for some locales,
+//   without parenthesis the function applies to the remaining expression
+uint32_t
+Syntax::parse_call(Ast& ast, const Token& function)
+{
+    std::vector<uint32_t> arguments;
+    if (m_hasToken
+     && m_token.kind == TokenKind::LeftParen) {
+        advance();
+        while (true) {
+            arguments.push_back(parse_expression(ast, 0));
+            if (!m_hasToken
+             || m_token.kind != TokenKind::Delim) {
+                break;
             }
-            //pop the left parenthesis from the operator stack and discard it
-            ops.pop();
-            if (!ops.empty()) {
-                //if there is a function token at the top of the operator stack, then:
-                auto frontToken = ops.top();
-                std::shared_ptr<IdToken> idToken = std::dynamic_pointer_cast<IdToken>(frontToken);
-                if (idToken) {
-                    //    pop the function from the operator stack into the output queue
-                    queue.push_back(idToken);
-                    ops.pop();
-                }
+            advance();
+        }
+        expect_right_paren();
+    }
+    else {
+        arguments.push_back(parse_expression(ast, 0));
+    }
+    return ast.add(function, arguments);
+}
+
+// the elements of a list literal [1; 2; 3], expected behind [
+uint32_t
+Syntax::parse_list(Ast& ast)
+{
+    std::vector<uint32_t> elements;
+    if (m_hasToken
+     && m_token.kind != TokenKind::RightBracket) {
+        while (true) {
+            elements.push_back(parse_expression(ast, 0));
+            if (!m_hasToken
+             || m_token.kind != TokenKind::Delim) {
+                break;
             }
+            advance();
         }
     }
-	///* After the while loop, pop the remaining items from the operator stack into the output queue. */
-	//while there are tokens on the operator stack:
-	while (!ops.empty()) {
-		auto frontToken = ops.top();
-		ops.pop();
-		//    /* If the operator token on the top of the stack is a parenthesis, then there are mismatched parentheses. */
-		//    {assert the operator on top of the stack is not a (left) parenthesis}
-		auto opToken = std::dynamic_pointer_cast<OpToken>(frontToken);
-		if (opToken && opToken->is_left_paren()) {
-			throw EvalError(Glib::ustring::sprintf("Missmatched parenthesis %s", opToken->show()));
-		}
-		//    pop the operator from the operator stack onto the output queue
-		queue.push_back(frontToken);
-	}
-	return queue;
+    if (!m_hasToken
+     || m_token.kind != TokenKind::RightBracket) {
+        throw EvalError(Glib::ustring::sprintf("Missmatched bracket at %d", static_cast<int>(m_pos)));
+    }
+    advance();
+    return ast.add(Token{TokenKind::List}, elements);
 }
 
-std::list<std::shared_ptr<Token>>
-Syntax::lexing(Glib::ustring& input)
+void
+Syntax::expect_right_paren()
 {
-    Glib::ustring::iterator index = input.begin();
-    std::list<std::shared_ptr<Token>> tokens;
-    while (true) {
-        std::shared_ptr<Token> token = get_next_token(input, index);
-        if (!token)
-            break;
-        //g_print("Token: %s at %i\n", token2str(token), token->position);
-        tokens.push_back(token);
+    if (!m_hasToken
+     || m_token.kind != TokenKind::RightParen) {
+        throw EvalError(Glib::ustring::sprintf("Missmatched parenthesis at %d", static_cast<int>(m_pos)));
     }
+    advance();
+}
 
-    return tokens;
+void
+Syntax::unexpected()
+{
+    throw EvalError(Glib::ustring::sprintf("Unexpected \"%s\" at %d"
+                    , Glib::ustring{std::string(m_input.substr(m_tokenPos, m_pos - m_tokenPos))}
+                    , static_cast<int>(m_tokenPos)));
 }
 
-std::shared_ptr<Token>
-Syntax::get_next_token(Glib::ustring& input, Glib::ustring::iterator& i)
+bool
+Syntax::get_next_token(std::string_view input, size_t& pos, Token* token)
 {
-    std::shared_ptr<Token> token;
+    gunichar c{};
     while (true) {
-        if (i == input.end())
-            return token;
-        if (!g_unichar_isspace(*i)) // also skips \t \n
+        if (pos >= input.size())
+            return false;
+        size_t len;
+        c = Utf8::decode(input, pos, &len);
+        if (!Utf8::is_space(c)) // also skips \t \n
             break;
-        ++i;
+        pos += len;
     }
 
-    Glib::ustring remain = input.substr(std::distance(input.begin(), i));
-	std::shared_ptr<NumToken> numToken = NumToken::create(remain, i, m_numberFormat);
-	if (numToken) {
-		return numToken;
-	}
-	std::shared_ptr<DelimToken> delimToken = DelimToken::create(remain, i);
-	if (delimToken) {
-		return delimToken;
-	}
-    std::shared_ptr<OpToken> opToken = parseOp(remain, i);
-	if (opToken) {
-		return opToken;
+	if (Token::read_number(input, pos, m_numberFormat, token)
+	 || Token::read_delim(input, pos, token)
+	 || parseOp(input, pos, token)
+	 || Token::read_assign(input, pos, token)
+	 || Token::read_id(input, pos, token)) {
+		return true;
 	}
-	std::shared_ptr<AssignToken> assignToken = AssignToken::create(remain, i);
-	if (assignToken) {
-		return assignToken;
-	}
-	std::shared_ptr<IdToken> idToken = IdToken::create(remain, i);
-	if (idToken) {
-		return idToken;
-	}
-    //    auto otherToken = std::make_shared<OtherToken>();
-    //    otherToken->other = c;
-    //    token = otherToken;
-	throw LexingError(Glib::ustring::sprintf("Cannot parse char %c", *i));
-    //++i;
-    //token->position = std::distance(input.begin(), i);
-
-    //index = i;
-    //return token;
+	throw LexingError(Glib::ustring::sprintf("Cannot parse char %s at %d"
+                        , Glib::ustring(1, c), static_cast<int>(pos)));
 }
 
-std::shared_ptr<OpToken>
-Syntax::parseOp(const Glib::ustring& value, Glib::ustring::iterator& i)
+bool
+Syntax::parseOp(std::string_view input, size_t& pos, Token* token)
 {
-	return OpToken::create(value, i);
+	return Token::read_op(input, pos, token);
 }
@@ -24,33 +24,55 @@
 #ifndef _MSC_VER
 #   include <cxxabi.h>
 #endif
-#include <list>
-#include <queue>
 #include <memory>
+#include <string_view>
 
 #include "NumberFormat.hpp"
 #include "Token.hpp"
+#include "Ast.hpp"
 
 class BaseEval;
 
+/*
+ * parse a expression into a tree in one pass,
+ *   the tokens are read as needed, and operators
+ *   are bound by precedence climbing (Pratt).
+ */
 class Syntax {
 public:
     Syntax(const PtrNumberFormat& numberFormat, const std::shared_ptr<BaseEval>& conversionContext);
     ~Syntax() = default;
 
-    std::list<std::shared_ptr<Token>> parse(Glib::ustring& input);
+    Ast parse(Glib::ustring& input);
+    // the input is expected as utf-8
+    Ast parse(std::string_view input);
 
+    // limit recursion for nested parenthesis or right associative chains
+    static constexpr unsigned NESTING_LIMIT{1000};
 protected:
+    bool get_next_token(std::string_view input, size_t& pos, Token* token);
+    virtual bool parseOp(std::string_view input, size_t& pos, Token* token);
 
-    std::list<std::shared_ptr<Token>> lexing(Glib::ustring& input);
-    std::shared_ptr<Token> get_next_token(Glib::ustring& input, Glib::ustring::iterator& index);
-    virtual std::shared_ptr<OpToken> parseOp(const Glib::ustring& value, Glib::ustring::iterator& i);
-
-    std::list<std::shared_ptr<Token>> shuntingYard(std::list<std::shared_ptr<Token>> tokens);
-    void insertNegate(std::list<std::shared_ptr<Token>>& tokens);
 private:
+    void advance();
+    uint32_t parse_statement(Ast& ast);
+    uint32_t parse_definition(Ast& ast, const Token& function);
+    uint32_t parse_expression(Ast& ast, int minPrecedence);
+    uint32_t parse_operand(Ast& ast);
+    uint32_t parse_call(Ast& ast, const Token& function);
+    uint32_t parse_list(Ast& ast);
+    void expect_right_paren();
+    [[noreturn]] void unexpected();
+
     const PtrNumberFormat m_numberFormat;
     std::shared_ptr<BaseEval> m_conversionContext;
+    // parse state
+    std::string_view m_input;
+    size_t m_pos{};
+    size_t m_tokenPos{};        // start of m_token
+    Token m_token{TokenKind::Number};
+    bool m_hasToken{};          // false at end of input
+    unsigned m_nesting{};
 };
 
 template <class T>
@@ -16,467 +16,220 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <iostream>
-#include <iterator>
-#include <locale.h>
+#include <array>
 #include <cmath>
 
 #include "NumberFormat.hpp"
 #include "Token.hpp"
+#include "Utf8.hpp"
 
-Token::Token()
+namespace {
+
+struct OpInfo
 {
-}
+    int precedence;
+    bool leftAssoc;
+    bool binary;
+};
+
+// operator properties indexed by OpCode, entries for non operators are not used
+constexpr std::array<OpInfo, static_cast<size_t>(OpCode::Reduce) + 1> OP_INFO{{
+     {0, true, true}    // Const
+    ,{0, true, true}    // Load
+    ,{0, true, true}    // Param
+    ,{0, true, true}    // Call
+    ,{0, true, true}    // CallN
+    ,{11, true, true}   // Add
+    ,{11, true, true}   // Sub
+    ,{12, true, true}   // Mul
+    ,{12, true, true}   // Div
+    ,{12, true, true}   // Mod
+    ,{13, false, true}  // Pow
+    ,{10, true, true}   // Shl
+    ,{10, true, true}   // Shr
+    ,{7, true, true}    // And
+    ,{5, true, true}    // Or
+    ,{13, false, false} // Neg
+    ,{0, true, true}    // Dup
+    ,{0, true, true}    // PowI
+    ,{0, true, true}    // Form
+    ,{0, true, true}    // Reduce
+}};
 
-Token::~Token()
+constexpr int PAREN_PRECEDENCE{15};
+
+const OpInfo&
+op_info(OpCode code)
 {
+    return OP_INFO[static_cast<size_t>(code)];
 }
 
+}
 
-NumToken::NumToken(double val)
-: m_val{val}
+int
+Token::precedence() const
 {
+    if (kind == TokenKind::LeftParen
+     || kind == TokenKind::RightParen) {
+        return PAREN_PRECEDENCE;
+    }
+    return op_info(code).precedence;
 }
 
-double
-NumToken::getValue()
+bool
+Token::is_left_assoc() const
 {
-	return m_val;
+    return op_info(code).leftAssoc;
 }
 
-std::shared_ptr<NumToken>
-NumToken::create(const Glib::ustring& val, Glib::ustring::iterator& i, const PtrNumberFormat& numberFormat)
+bool
+Token::read_number(std::string_view input, size_t& pos, const PtrNumberFormat& numberFormat, Token* token)
 {
-	std::shared_ptr<NumToken> numToken;
-    gunichar c = *i;
-    struct lconv* lconv = localeconv();
-    if (g_unichar_isdigit(c) || c == static_cast<gunichar>(lconv->decimal_point[0])) {
+    size_t len;
+    gunichar c = Utf8::decode(input, pos, &len);
+    auto remain = input.substr(pos);
+    if (Utf8::is_digit(c) || remain.starts_with(numberFormat->get_decimal_point())) {
     	std::string::size_type conv;
 		double num;
-        if (!numberFormat->parse(val, num, &conv)) {
-            Glib::ustring err = Glib::ustring::sprintf("Cound not read number at %d", *i);
+        if (!numberFormat->parse(remain, num, &conv)) {
+            Glib::ustring err = Glib::ustring::sprintf("Cound not read number at %d", static_cast<int>(pos));
             throw LexingError(err);
         }
-		//std::cout << "Parsed " << val << " to " << num << " places " << conv << std::endl;
-		numToken = std::make_shared<NumToken>(num);
-        std::advance(i, conv);
+        *token = Token{TokenKind::Number};
+        token->value = num;
+        pos += conv;
+        return true;
     }
-	return numToken;
-}
-
-Glib::ustring
-NumToken::show()
-{
-	return Glib::ustring::sprintf("%f", m_val);
-}
-
-DelimToken::DelimToken()
-{
+	return false;
 }
 
-std::shared_ptr<DelimToken>
-DelimToken::create(const Glib::ustring& value, Glib::ustring::iterator& i)
+bool
+Token::read_delim(std::string_view input, size_t& pos, Token* token)
 {
-	std::shared_ptr<DelimToken> delimToken;
-    gunichar c = *i;
-	if (c == ';') {	// need to use ; as , may be decimal separator for some locales
-		delimToken = std::make_shared<DelimToken>();
-		++i;
+	if (input[pos] == ';') {	// need to use ; as , may be decimal separator for some locales
+        *token = Token{TokenKind::Delim};
+		++pos;
+        return true;
 	}
-	return delimToken;
-}
-
-Glib::ustring
-DelimToken::show()
-{
-	return ";";
-}
-
-OpToken::OpToken(gunichar op)
-: m_op{op}
-{
+	return false;
 }
 
-std::shared_ptr<OpToken>
-OpToken::create(const Glib::ustring& value, Glib::ustring::iterator& i)
+bool
+Token::read_op(std::string_view input, size_t& pos, Token* token)
 {
-	std::shared_ptr<OpToken> opToken;
-    Glib::ustring::iterator next = i;
-	++next;
+    size_t len;
+	gunichar c = Utf8::decode(input, pos, &len);
+    size_t next = pos + len;
 	gunichar nc = ' ';
-	bool isNext = next != value.end();
+	bool isNext = next < input.size();
 	if (isNext) {
-		nc = *next;
+		nc = static_cast<unsigned char>(input[next]);    // only ascii is of interest
+	}
+    *token = Token{TokenKind::Op};
+    token->op = c;
+	if (c == '+') {
+        token->code = OpCode::Add;
 	}
-	gunichar c = *i;
-	if (c == '+'
-	 || OpAddToken::is_minus(c)) {
-		opToken = std::make_shared<OpAddToken>(c);
-		++i;
+	else if (is_minus(c)) {
+        token->code = OpCode::Sub;
 	}
 	else if (c == '^'
 		  || (isNext && c == '*' && nc == '*')) {
-		opToken = std::make_shared<OpPowToken>('^');
-		if (isNext && c == '*' && nc == '*') {
-            i = next;
+        token->code = OpCode::Pow;
+        token->op = '^';
+		if (c == '*') {
+            ++next;
 		}
-		++i;
 	}
-	else if (c == '%'
-		  || OpMulToken::is_mult(c)
-		  || OpMulToken::is_div(c)) {
-		opToken = std::make_shared<OpMulToken>(c);
-		++i;
+	else if (c == '%') {
+        token->code = OpCode::Mod;
+	}
+	else if (is_mult(c)) {
+        token->code = OpCode::Mul;
+	}
+	else if (is_div(c)) {
+        token->code = OpCode::Div;
 	}
 	else if (c == '<'
 		  || c == '>') {
-		opToken = std::make_shared<OpShiftToken>(c);
+        token->code = c == '<' ? OpCode::Shl : OpCode::Shr;
 		if (isNext && nc == c) {
-            i = next;
+            ++next;
 		}
-		++i;
 	}
-	else if (c == '&'
-		  || c == '|') {
-		opToken = std::make_shared<OpBitsToken>(c);
-		++i;
+	else if (c == '&') {
+        token->code = OpCode::And;
 	}
-	else if (c == '('
-			|| c == ')') {
-		opToken = std::make_shared<OpParenToken>(c);
-		++i;
+	else if (c == '|') {
+        token->code = OpCode::Or;
 	}
-
-	return opToken;
+	else if (c == '(') {
+        token->kind = TokenKind::LeftParen;
+	}
+	else if (c == ')') {
+        token->kind = TokenKind::RightParen;
+	}
+	else if (c == '[') {
+        token->kind = TokenKind::LeftBracket;
+	}
+	else if (c == ']') {
+        token->kind = TokenKind::RightBracket;
+	}
+    else {
+        return false;
+    }
+    pos = next;
+	return true;
 }
 
 bool
-OpToken::is_left_paren()
+Token::read_assign(std::string_view input, size_t& pos, Token* token)
 {
+	if (input[pos] == '=') {
+        *token = Token{TokenKind::Assign};
+		++pos;
+        return true;
+	}
 	return false;
 }
 
 bool
-OpToken::is_right_paren()
-{
+Token::read_id(std::string_view input, size_t& pos, Token* token)
+{
+    size_t len;
+	gunichar c = Utf8::decode(input, pos, &len);
+    if (Utf8::is_alpha(c)) {
+        size_t end = pos + len;
+        while (end < input.size()
+            && Utf8::is_alnum(Utf8::decode(input, end, &len))) {	// use isalnum for parsing e.g. ln2
+            end += len;
+        }
+        *token = Token{TokenKind::Id};
+        token->offset = static_cast<uint32_t>(pos);
+        token->length = static_cast<uint32_t>(end - pos);
+        pos = end;
+        return true;
+    }
 	return false;
 }
 
 bool
-OpToken::is_left_assoc()
-{
-	return true;	// assoc left
-}
-
-gunichar
-OpToken::get_op()
-{
-	return m_op;
-}
-
-Glib::ustring
-OpToken::show()
-{
-	return Glib::ustring::sprintf("%c", m_op);
-}
-
-bool OpToken::is_binary()
-{
-	return true;	// default to binary
-}
-
-OpAddToken::OpAddToken(gunichar opAdd)
-: OpToken(opAdd)
-{
-}
-
-int
-OpAddToken::precedence()
-{
-	return 11;
-}
-
-double
-OpAddToken::eval(double valL, double valR)
-{
-	if (is_minus(m_op)) {
-		return valL - valR;
-	}
-	if (m_op == '+') {
-		return valL + valR;
-	}
-	throw EvalError(Glib::ustring::format("Unexpected add operator %c", m_op));
-}
-
-bool OpAddToken::is_minus(gunichar c)
+Token::is_minus(gunichar c)
 {
 	return c == '-'
 		|| c == L'\u2212';		// − using gutf8.c functions here seem most convenient
 }
 
-OpMulToken::OpMulToken(gunichar opMul)
-: OpToken(opMul)
-{
-}
-
-int
-OpMulToken::precedence()
-{
-	return 12;
-}
-
 bool
-OpMulToken::is_mult(gunichar c)
+Token::is_mult(gunichar c)
 {
 	return c == '*'		// \u2217 ∗ alternative ?
 		|| c == L'\u00d7';		// ×
 }
 
 bool
-OpMulToken::is_div(gunichar c)
+Token::is_div(gunichar c)
 {
 	return c == '/'
 		|| c == L'\u00f7';	// ÷ wiki says used as minus in Scandinavia
 }
-
-double
-OpMulToken::eval(double valL, double valR)
-{
-	if (is_div(m_op)) {
-		return valL / valR;
-	}
-	if (m_op == '%') {
-		return std::fmod(valL, valR);
-	}
-	if (is_mult(m_op)) {
-		return valL * valR;
-	}
-	throw EvalError(Glib::ustring::format("Unexpected mult operator %c", m_op));
-}
-
-OpPowToken::OpPowToken(gunichar opPow)
-: OpToken(opPow)
-{
-}
-
-int
-OpPowToken::precedence()
-{
-	return 13;
-}
-
-double
-OpPowToken::eval(double valL, double valR)
-{
-	switch (m_op) {
-	case '^':
-		return std::pow(valL, valR);;
-	default:
-		throw EvalError(Glib::ustring::format("Unexpected pow operator %c", m_op));
-	}
-}
-
-bool
-OpPowToken::is_left_assoc()
-{
-	return false;	// assoc right
-}
-
-OpParenToken::OpParenToken(gunichar opParen)
-: OpToken(opParen)
-{
-}
-
-bool
-OpParenToken::is_left_paren()
-{
-	return m_op == '(';
-}
-
-bool
-OpParenToken::is_right_paren()
-{
-	return m_op == ')';
-}
-
-int OpParenToken::precedence()
-{
-	return 15;
-}
-
-double
-OpParenToken::eval(double valL, double valR)
-{
-	throw EvalError("Parenthese shoud not get evaluated!");
-}
-
-OpShiftToken::OpShiftToken(gunichar opShift)
-: OpToken(opShift)
-{
-
-}
-
-int
-OpShiftToken::precedence()
-{
-	return 10;
-}
-
-double
-OpShiftToken::eval(double valL, double valR)
-{
-	switch (m_op) {
-	case '<':
-		return static_cast<double>(static_cast<uint64_t>(valL) << static_cast<uint64_t>(valR));
-	case '>':
-		return static_cast<double>(static_cast<uint64_t>(valL) >> static_cast<uint64_t>(valR));
-	default:
-		throw EvalError(Glib::ustring::format("Unexpected shift operator %c", m_op));
-	}
-}
-
-OpBitsToken::OpBitsToken(gunichar opBits)
-: OpToken(opBits)
-{
-}
-
-int
-OpBitsToken::precedence()
-{
-	switch (m_op) {
-	case '&':
-		return 7;
-	case '|':
-		return 5;
-	default:
-		throw EvalError(Glib::ustring::format("Unexpected bit operator %c", m_op));
-	}
-}
-
-double
-OpBitsToken::eval(double valL, double valR)
-{
-	switch (m_op) {
-	case '&':
-		return (uint64_t)valL & (uint64_t)valR;
-	case '|':
-		return (uint64_t)valL | (uint64_t)valR;
-	default:
-		throw EvalError(Glib::ustring::format("Unexpected bit operator %c", m_op));
-	}
-}
-
-NegateToken::NegateToken(gunichar op)
-: OpToken(op)
-{
-}
-
-int
-NegateToken::precedence()
-{
-	return 13;
-}
-
-double NegateToken::eval(double valL, double valR)
-{
-	return -valR;
-}
-
-bool
-NegateToken::is_left_assoc()
-{
-	return false;	// assoc right
-}
-
-bool
-NegateToken::is_binary()
-{
-	return false;	// here we are unary
-}
-
-Glib::ustring
-NegateToken::show()
-{
-    return "u-";
-}
-
-AssignToken::AssignToken()
-{
-}
-
-AssignToken::~AssignToken()
-{
-}
-
-std::shared_ptr<AssignToken>
-AssignToken::create(const Glib::ustring& value, Glib::ustring::iterator& i)
-{
-	std::shared_ptr<AssignToken> assignToken;
-	gunichar c = *i;
-	if (c == '=') {
-		assignToken = std::make_shared<AssignToken>();
-		++i;
-	}
-	return assignToken;
-}
-
-Glib::ustring
-AssignToken::show()
-{
-	return "=";
-}
-
-IdToken::IdToken(const Glib::ustring& id)
-: m_id{id}
-, m_function{false}
-{
-}
-
-IdToken::~IdToken()
-{
-}
-
-std::shared_ptr<IdToken>
-IdToken::create(Glib::ustring& value, Glib::ustring::iterator& i)
-{
-	std::shared_ptr<IdToken> idToken;
-	gunichar c = *i;
-    if (g_unichar_isalpha(c)) {
-        Glib::ustring::iterator end = i;
-        while ((end != value.end())
-			&& g_unichar_isalnum(*end)) {	// use isalnum for parsing e.g. ln2
-            ++end;
-        }
-		// auto start = std::distance(value.begin(), i);
-		auto remain = std::distance(i, end);
-        Glib::ustring id = value.substr(0, remain);
-        idToken = std::make_shared<IdToken>(id);
-        //std::cout << "start " << std::distance(input.begin(), i) << " len " << std::distance(i, e) << " id \"" << id << "\"" << std::endl;
-        i = end;
-    }
-	return idToken;
-}
-
-Glib::ustring
-IdToken::getId()
-{
-	return m_id;
-}
-
-void
-IdToken::set_function(bool function)
-{
-	m_function = function;
-}
-
-bool
-IdToken::is_function()
-{
-	return m_function;
-}
-
-Glib::ustring
-IdToken::show()
-{
-	return m_id;
-}
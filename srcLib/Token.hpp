@@ -20,6 +20,11 @@
 
 #include <glibmm.h>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "Program.hpp"
 
 class ParseError
 : public std::exception
@@ -62,157 +67,50 @@ public:
     }
 };
 
-class Token
+enum class TokenKind : uint8_t
 {
-public:
-    Token();
-    virtual ~Token();
-
-    virtual Glib::ustring show() = 0;
-private:
-
+    Number,
+    Id,
+    Op,             // binary operator
+    Negate,         // unary minus
+    LeftParen,
+    RightParen,
+    Delim,
+    Assign,
+    LeftBracket,
+    RightBracket,
+    List            // list literal, the operands are the elements
 };
 
 class NumberFormat;
 using PtrNumberFormat = std::shared_ptr<NumberFormat>;
 
-class NumToken : public Token
-{
-public:
-    NumToken(double val);
-
-    static std::shared_ptr<NumToken> create(const Glib::ustring& val,
-                                        Glib::ustring::iterator& i,
-                                        const PtrNumberFormat& numberFormat);
-    Glib::ustring show() override;
-    double getValue();
-private:
-    double m_val;
-};
-
-class DelimToken : public Token
-{
-public:
-    DelimToken();
-
-    static std::shared_ptr<DelimToken> create(const Glib::ustring& value, Glib::ustring::iterator& i);
-    Glib::ustring show() override;
-};
-
-class OpToken : public Token
-{
-public:
-    OpToken(gunichar op);
-
-    static std::shared_ptr<OpToken> create(const Glib::ustring& value, Glib::ustring::iterator& i);
-    Glib::ustring show() override;
-
-    virtual bool is_left_paren();
-    virtual bool is_right_paren();
-
-    virtual int precedence() = 0;
-    virtual bool is_left_assoc();
-    gunichar get_op();
-    virtual double eval(double valL, double valR) = 0;
-    virtual bool is_binary();
-protected:
-    gunichar m_op;
-};
-
-class OpAddToken : public OpToken
-{
-public:
-    OpAddToken(gunichar op);
+/*
+ * a token is a plain value, the kind tells which fields are used.
+ *   Ids refer to the parsed text by position,
+ *   operators are described by their OpCode.
+ */
+struct Token
+{
+    TokenKind kind;
+    OpCode code{};          // Op, Negate
+    gunichar op{};          // Op: as written, for display
+    bool function{};        // Id: resolved as function by the parser
+    uint32_t offset{};      // Id: position in text
+    uint32_t length{};
+    double value{};         // Number
+
+    int precedence() const;
+    bool is_left_assoc() const;
+
+    // read the token of the kind at pos, on success pos is moved behind it
+    static bool read_number(std::string_view input, size_t& pos, const PtrNumberFormat& numberFormat, Token* token);
+    static bool read_delim(std::string_view input, size_t& pos, Token* token);
+    static bool read_op(std::string_view input, size_t& pos, Token* token);
+    static bool read_assign(std::string_view input, size_t& pos, Token* token);
+    static bool read_id(std::string_view input, size_t& pos, Token* token);
 
-    int precedence() override;
-    double eval(double valL, double valR) override;
     static bool is_minus(gunichar c);
-};
-
-class OpMulToken : public OpToken
-{
-public:
-    OpMulToken(gunichar op);
-
-    int precedence() override;
-    double eval(double valL, double valR) override;
     static bool is_mult(gunichar c);
     static bool is_div(gunichar c);
 };
-
-class OpPowToken : public OpToken
-{
-public:
-    OpPowToken(gunichar op);
-
-    int precedence() override;
-    bool is_left_assoc() override;
-    double eval(double valL, double valR) override;
-};
-
-class OpParenToken : public OpToken
-{
-public:
-    OpParenToken(gunichar op);
-
-    int precedence() override;
-    bool is_left_paren() override;
-    bool is_right_paren() override;
-    double eval(double valL, double valR) override;
-};
-
-class OpShiftToken : public OpToken
-{
-public:
-    OpShiftToken(gunichar op);
-
-    int precedence() override;
-    double eval(double valL, double valR) override;
-};
-
-class OpBitsToken : public OpToken
-{
-public:
-    OpBitsToken(gunichar op);
-
-    int precedence() override;
-    double eval(double valL, double valR) override;
-};
-
-class NegateToken : public OpToken
-{
-public:
-    NegateToken(gunichar op);
-
-    int precedence() override;
-    double eval(double valL, double valR) override;
-    bool is_left_assoc() override;
-    bool is_binary() override;
-    Glib::ustring show() override;
-};
-
-class AssignToken : public Token
-{
-public:
-    AssignToken();
-    virtual ~AssignToken();
-
-    static std::shared_ptr<AssignToken> create(const Glib::ustring& value, Glib::ustring::iterator& i);
-    Glib::ustring show() override;
-};
-
-class IdToken : public Token
-{
-public:
-    IdToken(const Glib::ustring& id);
-    virtual ~IdToken();
-
-    static std::shared_ptr<IdToken> create(Glib::ustring& value, Glib::ustring::iterator& i);
-    Glib::ustring show() override;
-    Glib::ustring getId();
-    void set_function(bool function);
-    bool is_function();
-private:
-    Glib::ustring m_id;
-    bool m_function;
-};
@@ -0,0 +1,130 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include "UserFunction.hpp"
+#include "EvalFrame.hpp"
+
+UserFunction::UserFunction(const Glib::ustring& name, const std::vector<Glib::ustring>& params
+                         , const PtrProgram& body, const PtrProgram& source, const Glib::ustring& definition)
+: m_name{name}
+, m_params{params}
+, m_body{body}
+, m_source{source}
+, m_definition{definition}
+{
+    // variables may change, so just a body of constants and pure functions
+    //   may be evaluated on compile
+    for (auto& instr : m_body->get_code()) {
+        if (instr.code == OpCode::Load
+         || instr.code == OpCode::Form
+         || instr.code == OpCode::Reduce
+         || (instr.function && instr.function->depends_on_context())) {
+            m_dependsOnContext = true;
+        }
+    }
+}
+
+double
+UserFunction::eval(double argument, EvalFrame* frame)
+{
+    return frame->eval(*m_body, std::span<const double>(&argument, 1));
+}
+
+void
+UserFunction::eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame)
+{
+    frame->eval_batch(*m_body, in, out);
+}
+
+Interval
+UserFunction::eval_interval(const Interval& arg, EvalFrame* frame)
+{
+    return frame->eval_interval(*m_body, std::span<const Interval>(&arg, 1));
+}
+
+Dual
+UserFunction::eval_dual(const Dual& arg, EvalFrame* frame)
+{
+    return frame->eval_dual(*m_body, std::span<const Dual>(&arg, 1));
+}
+
+bool
+UserFunction::depends_on_context()
+{
+    return m_dependsOnContext;
+}
+
+size_t
+UserFunction::get_arity()
+{
+    return m_params.size();
+}
+
+double
+UserFunction::eval_args(std::span<const double> args, EvalFrame* frame)
+{
+    return frame->eval(*m_body, args);
+}
+
+Interval
+UserFunction::eval_interval_args(std::span<const Interval> args, EvalFrame* frame)
+{
+    return frame->eval_interval(*m_body, args);
+}
+
+Dual
+UserFunction::eval_dual_args(std::span<const Dual> args, EvalFrame* frame)
+{
+    return frame->eval_dual(*m_body, args);
+}
+
+const Glib::ustring&
+UserFunction::get_name() const
+{
+    return m_name;
+}
+
+const Glib::ustring&
+UserFunction::get_definition() const
+{
+    return m_definition;
+}
+
+const PtrProgram&
+UserFunction::get_body() const
+{
+    return m_body;
+}
+
+const PtrProgram&
+UserFunction::get_source() const
+{
+    return m_source;
+}
+
+bool
+UserFunction::is_inline() const
+{
+    auto& code = m_source->get_code();
+    return code.size() <= INLINE_LIMIT
+        && std::none_of(code.begin(), code.end(), [] (const Instruction& instr) {
+                return instr.code == OpCode::Form
+                    || instr.code == OpCode::Reduce;
+            });
+}
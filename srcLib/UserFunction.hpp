@@ -0,0 +1,71 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <glibmm.h>
+#include <vector>
+
+#include "Function.hpp"
+#include "Program.hpp"
+
+/*
+ * a function defined by the user e.g. f(x; y) = x^2 + y,
+ *   the body is compiled with the parameters bound by position,
+ *   so a call will not touch the variables.
+ *   A small body is inlined by BaseEval::compile at the call,
+ *   otherwise the call evaluates the body with the frame of the caller.
+ *   The source is the body before optimization, that is inlined,
+ *   so the Optimizer sees it together with the arguments.
+ */
+class UserFunction : public Function
+{
+public:
+    // definition is the text e.g. to save and restore the function
+    UserFunction(const Glib::ustring& name, const std::vector<Glib::ustring>& params
+               , const PtrProgram& body, const PtrProgram& source, const Glib::ustring& definition);
+    explicit UserFunction(const UserFunction& orig) = delete;
+    virtual ~UserFunction() = default;
+
+    double eval(double argument, EvalFrame* frame) override;
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override;
+    Interval eval_interval(const Interval& arg, EvalFrame* frame) override;
+    Dual eval_dual(const Dual& arg, EvalFrame* frame) override;
+    bool depends_on_context() override;
+    size_t get_arity() override;
+    double eval_args(std::span<const double> args, EvalFrame* frame) override;
+    Interval eval_interval_args(std::span<const Interval> args, EvalFrame* frame) override;
+    Dual eval_dual_args(std::span<const Dual> args, EvalFrame* frame) override;
+
+    const Glib::ustring& get_name() const;
+    const Glib::ustring& get_definition() const;
+    const PtrProgram& get_body() const;
+    const PtrProgram& get_source() const;
+    // small enough to copy the body to the caller,
+    //   a form or reduction is not as it binds the parameters of its program
+    bool is_inline() const;
+
+    // bodies up to this count of instructions are inlined
+    static constexpr size_t INLINE_LIMIT{16};
+private:
+    Glib::ustring m_name;
+    std::vector<Glib::ustring> m_params;
+    PtrProgram m_body;
+    PtrProgram m_source;
+    Glib::ustring m_definition;
+    bool m_dependsOnContext{false};
+};
@@ -0,0 +1,66 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glibmm.h>
+#include <string_view>
+
+/*
+ * scanning of a utf-8 buffer by byte position,
+ *   the character classes take a shortcut for ascii
+ *   as this is what most expressions consist of.
+ */
+class Utf8
+{
+public:
+    // the character at pos and its length in bytes,
+    //   invalid sequences give (gunichar)-1
+    static gunichar decode(std::string_view input, size_t pos, size_t* len)
+    {
+        auto c = static_cast<unsigned char>(input[pos]);
+        if (c < 0x80u) {
+            *len = 1;
+            return c;
+        }
+        const gchar* start = input.data() + pos;
+        gunichar uc = g_utf8_get_char_validated(start, static_cast<gssize>(input.size() - pos));
+        if (uc >= static_cast<gunichar>(-2)) {
+            *len = 1;
+            return static_cast<gunichar>(-1);
+        }
+        *len = static_cast<size_t>(g_utf8_next_char(start) - start);
+        return uc;
+    }
+    static bool is_space(gunichar c)
+    {
+        return c < 0x80u ? c == ' ' || (c >= '\t' && c <= '\r') : g_unichar_isspace(c);
+    }
+    static bool is_digit(gunichar c)
+    {
+        return c < 0x80u ? c >= '0' && c <= '9' : g_unichar_isdigit(c);
+    }
+    static bool is_alpha(gunichar c)
+    {
+        return c < 0x80u ? (c | 0x20u) >= 'a' && (c | 0x20u) <= 'z' : g_unichar_isalpha(c);
+    }
+    static bool is_alnum(gunichar c)
+    {
+        return is_digit(c) || is_alpha(c);
+    }
+};
@@ -0,0 +1,87 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4; coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VariableStore.hpp"
+
+// get the slot for name, if it is unknown a undefined slot will be created
+size_t
+VariableStore::intern(const Glib::ustring& name)
+{
+    auto iter = m_index.find(name.raw());
+    if (iter != m_index.end()) {
+        return iter->second;
+    }
+    size_t slot = m_names.size();
+    m_index.insert(std::make_pair(name.raw(), slot));
+    m_names.push_back(name);
+    m_values.push_back(0.0);
+    m_defined.push_back(0);
+    m_constant.push_back(0);
+    m_lists.emplace_back();
+    return slot;
+}
+
+bool
+VariableStore::find(const Glib::ustring& name, size_t* slot) const
+{
+    auto iter = m_index.find(name.raw());
+    if (iter != m_index.end()) {
+        *slot = iter->second;
+        return true;
+    }
+    return false;
+}
+
+void
+VariableStore::remove(size_t slot)
+{
+    m_values[slot] = 0.0;
+    m_defined[slot] = 0;
+    m_lists[slot].reset();
+}
+
+void
+VariableStore::set_list(size_t slot, std::vector<double>&& values)
+{
+    m_values[slot] = 0.0;
+    m_defined[slot] = 0;
+    m_lists[slot] = std::make_shared<const std::vector<double>>(std::move(values));
+}
+
+const Glib::ustring&
+VariableStore::get_name(size_t slot) const
+{
+    return m_names[slot];
+}
+
+size_t
+VariableStore::size() const
+{
+    return m_names.size();
+}
+
+void
+VariableStore::assign(const VariableStore& other)
+{
+    m_index = other.m_index;
+    m_names = other.m_names;
+    m_values = other.m_values;
+    m_defined = other.m_defined;
+    m_constant = other.m_constant;
+    m_lists = other.m_lists;
+}
@@ -0,0 +1,95 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glibmm.h>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <string>
+#include <span>
+#include <cstdint>
+
+/*
+ * variables interned to dense slots,
+ *   names are only looked up when compiling,
+ *   evaluation will access the values by slot.
+ *   Slots are never reused, so compiled programs stay valid,
+ *   a removed variable just gets undefined.
+ *   A slot may hold a list instead of a value,
+ *   it is not defined as value then.
+ */
+class VariableStore
+{
+public:
+    VariableStore() = default;
+    explicit VariableStore(const VariableStore& orig) = delete;
+    virtual ~VariableStore() = default;
+
+    size_t intern(const Glib::ustring& name);
+    bool find(const Glib::ustring& name, size_t* slot) const;
+    bool is_defined(size_t slot) const
+    {
+        return m_defined[slot] != 0;
+    }
+    double get(size_t slot) const
+    {
+        return m_values[slot];
+    }
+    void set(size_t slot, double val)
+    {
+        m_values[slot] = val;
+        m_defined[slot] = 1;
+        m_lists[slot].reset();
+    }
+    bool is_list(size_t slot) const
+    {
+        return m_lists[slot] != nullptr;
+    }
+    // empty if the slot holds no list
+    std::span<const double> get_list(size_t slot) const
+    {
+        return m_lists[slot] ? std::span<const double>(*m_lists[slot]) : std::span<const double>();
+    }
+    void set_list(size_t slot, std::vector<double>&& values);
+    // a constant will never change, so it may be folded on compile
+    void set_constant(size_t slot, double val)
+    {
+        set(slot, val);
+        m_constant[slot] = 1;
+    }
+    bool is_constant(size_t slot) const
+    {
+        return m_constant[slot] != 0;
+    }
+    void remove(size_t slot);
+    // copy all of other e.g. to evaluate on a other thread
+    void assign(const VariableStore& other);
+    const Glib::ustring& get_name(size_t slot) const;
+    size_t size() const;
+
+private:
+    std::unordered_map<std::string, size_t> m_index;
+    std::vector<Glib::ustring> m_names;
+    std::vector<double> m_values;
+    std::vector<uint8_t> m_defined;
+    std::vector<uint8_t> m_constant;
+    // shared, as the lists are not changed, just replaced
+    std::vector<std::shared_ptr<const std::vector<double>>> m_lists;
+};
@@ -0,0 +1,564 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4; coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "VectorMath.hpp"
+
+namespace {
+
+constexpr size_t LEN{VectorMath::BLOCK};
+constexpr double HALF_PI{VectorMath::RIGHT_ANGLE};
+constexpr double HALF_PI_LO{6.123233995736766e-17};     // HALF_PI + HALF_PI_LO = pi/2
+// adding this rounds to an integer that is found in the low bits of the mantissa
+constexpr double SHIFT{0x1.8p52};
+
+inline uint64_t
+bits(double val)
+{
+    return std::bit_cast<uint64_t>(val);
+}
+
+inline double
+from_bits(uint64_t val)
+{
+    return std::bit_cast<double>(val);
+}
+
+// 2^n for a integral n in the normal range
+inline double
+pow2(double n)
+{
+    return from_bits((bits(n + SHIFT) - bits(SHIFT) + 1023u) << 52);
+}
+
+// a kernel works on a full block, with input and output not overlapping,
+//   the last block is padded with a value that is valid for all kernels
+template <typename Kernel>
+void
+for_blocks(std::span<const double> in, std::span<double> out, Kernel kernel)
+{
+    alignas(64) double x[LEN];
+    alignas(64) double y[LEN];
+    for (size_t start = 0; start < in.size(); start += LEN) {
+        const size_t count = std::min(LEN, in.size() - start);
+        std::copy_n(in.begin() + start, count, x);
+        std::fill(x + count, x + LEN, 0.5);
+        kernel(x, y);
+        std::copy_n(y, count, out.begin() + start);
+    }
+}
+
+// exp(r) for |r| <= ln2/2, taylor series up to r^13
+inline double
+exp_poly(double r)
+{
+    return 1.0 + r * (1.0 + r * (1.0 / 2.0 + r * (1.0 / 6.0 + r * (1.0 / 24.0
+        + r * (1.0 / 120.0 + r * (1.0 / 720.0 + r * (1.0 / 5040.0 + r * (1.0 / 40320.0
+        + r * (1.0 / 362880.0 + r * (1.0 / 3628800.0 + r * (1.0 / 39916800.0
+        + r * (1.0 / 479001600.0 + r * (1.0 / 6227020800.0)))))))))))));
+}
+
+constexpr double EXP_MIN{-708.0};   // keep 2^k and the result normal
+constexpr double EXP_MAX{709.0};
+constexpr double LOG2E{1.4426950408889634};
+constexpr double LN2_HI{0x1.62e42ff000000p-1};  // k * LN2_HI is exact
+constexpr double LN2_LO{-4.2009150726810846e-11};
+
+void
+exp_block(const double* __restrict x, double* __restrict y)
+{
+    for (size_t i = 0; i < LEN; ++i) {
+        const double v = std::min(std::max(x[i], EXP_MIN), EXP_MAX);
+        const double k = (v * LOG2E + SHIFT) - SHIFT;
+        const double r = (v - k * LN2_HI) - k * LN2_LO;
+        y[i] = exp_poly(r) * pow2(k);
+    }
+    for (size_t i = 0; i < LEN; ++i) {
+        if (!(x[i] >= EXP_MIN && x[i] <= EXP_MAX)) {
+            y[i] = std::exp(x[i]);
+        }
+    }
+}
+
+constexpr double SQRT2{1.4142135623730951};
+constexpr uint64_t MANTISSA{0x000fffffffffffffu};
+
+/*
+ * split a positive normal v into v = 2^e * (1 + f) with 1 + f in [sqrt(1/2), sqrt(2))
+ *   and return log(1 + f)
+ */
+inline double
+log_reduce(double v, double* e)
+{
+    const uint64_t u = bits(v);
+    double exponent = from_bits((u >> 52) | bits(0x1p52)) - (0x1p52 + 1023.0);
+    double m = from_bits((u & MANTISSA) | bits(1.0));
+    const bool high = m > SQRT2;
+    m = high ? m * 0.5 : m;
+    *e = high ? exponent + 1.0 : exponent;
+    // log(1 + f) = 2 atanh(s) with s = f / (2 + f), as in fdlibm
+    const double f = m - 1.0;
+    const double s = f / (2.0 + f);
+    const double z = s * s;
+    const double r = z * (2.0 / 3.0 + z * (2.0 / 5.0 + z * (2.0 / 7.0 + z * (2.0 / 9.0
+        + z * (2.0 / 11.0 + z * (2.0 / 13.0 + z * (2.0 / 15.0 + z * (2.0 / 17.0
+        + z * (2.0 / 19.0 + z * (2.0 / 21.0 + z * (2.0 / 23.0)))))))))));
+    const double hfsq = 0.5 * f * f;
+    return f - (hfsq - s * (hfsq + r));
+}
+
+// positive, normal and finite
+inline bool
+log_valid(double v)
+{
+    return bits(v) >= bits(0x1p-1022) && bits(v) < bits(INFINITY);
+}
+
+constexpr double LOG10E{0.4342944819032518};
+constexpr double LOG10_2_HI{0x1.3441350a00000p-2};   // e * LOG10_2_HI is exact
+constexpr double LOG10_2_LO{-1.9043128467164274e-12};
+
+template <typename Combine, typename Fallback>
+void
+log_block(const double* __restrict x, double* __restrict y, Combine combine, Fallback fallback)
+{
+    for (size_t i = 0; i < LEN; ++i) {
+        double e;
+        const double lm = log_reduce(x[i], &e);
+        y[i] = combine(e, lm);
+    }
+    for (size_t i = 0; i < LEN; ++i) {
+        if (!log_valid(x[i])) {
+            y[i] = fallback(x[i]);
+        }
+    }
+}
+
+// cbrt(m) for m in [0.5, 4), start value with 1.6% error, refined by halley's method
+inline double
+cbrt_reduced(double m)
+{
+    double y = 0.6051878792029299 + m * (0.4255738691868551 + m * -0.0465884192163252);
+    double y3 = y * y * y;
+    y = y * (y3 + 2.0 * m) / (2.0 * y3 + m);
+    y3 = y * y * y;
+    y = y * (y3 + 2.0 * m) / (2.0 * y3 + m);
+    // last step as correction, to keep the rounding error small
+    y3 = y * y * y;
+    return y - y * (y3 - m) / (2.0 * y3 + m);
+}
+
+void
+cbrt_block(const double* __restrict x, double* __restrict y)
+{
+    for (size_t i = 0; i < LEN; ++i) {
+        const double a = std::fabs(x[i]);
+        const uint64_t u = bits(a);
+        const double e = from_bits((u >> 52) | bits(0x1p52)) - (0x1p52 + 1023.0);
+        const double m = from_bits((u & MANTISSA) | bits(1.0));
+        // a = 2^(3 q + rem) * m with rem in -1, 0, 1
+        const double q = (e * (1.0 / 3.0) + SHIFT) - SHIFT;
+        const double rem = e - 3.0 * q;
+        const double mr = rem < 0.0 ? m * 0.5 : (rem > 0.0 ? m * 2.0 : m);
+        y[i] = std::copysign(cbrt_reduced(mr) * pow2(q), x[i]);
+    }
+    for (size_t i = 0; i < LEN; ++i) {
+        if (!log_valid(std::fabs(x[i]))) {
+            y[i] = std::cbrt(x[i]);
+        }
+    }
+}
+
+// sin(r) for |r| <= pi/4, taylor series up to r^17,
+//   the sign is that of r, so sin(-0) keeps it as libm does
+inline double
+sin_poly(double r)
+{
+    const double z = r * r;
+    return std::copysign(r + r * z * (-1.0 / 6.0 + z * (1.0 / 120.0 + z * (-1.0 / 5040.0 + z * (1.0 / 362880.0
+        + z * (-1.0 / 39916800.0 + z * (1.0 / 6227020800.0 + z * (-1.0 / 1307674368000.0
+        + z * (1.0 / 355687428096000.0)))))))), r);
+}
+
+// cos(r) for |r| <= pi/4, taylor series up to r^18
+inline double
+cos_poly(double r)
+{
+    const double z = r * r;
+    return 1.0 - 0.5 * z + z * z * (1.0 / 24.0 + z * (-1.0 / 720.0 + z * (1.0 / 40320.0
+        + z * (-1.0 / 3628800.0 + z * (1.0 / 479001600.0 + z * (-1.0 / 87178291200.0
+        + z * (1.0 / 20922789888000.0 + z * (-1.0 / 6402373705728000.0))))))));
+}
+
+// pi/2 in three parts, n * PIO2_1 and n * PIO2_2 are exact for |n| < 2^19
+constexpr double PIO2_1{0x1.921fb54400000p+0};
+constexpr double PIO2_2{0x1.0b4611a600000p-34};
+constexpr double PIO2_3{0x1.3198a2e037073p-69};
+constexpr double TRIG_QUADRANTS{0x1p19};
+
+inline double
+to_radian(double v, double rightAngle)
+{
+    return rightAngle == HALF_PI ? v : v * HALF_PI / rightAngle;
+}
+
+// n mod 4 for a integral n, as -2 ... 2 with 2 and -2 both meaning 2, -1 meaning 3
+inline double
+quadrant(double n)
+{
+    return n - 4.0 * ((n * 0.25 + SHIFT) - SHIFT);
+}
+
+// reduce v = n * pi/2 + r, |r| <= pi/4, returns n
+inline double
+reduce_radian(double v, double* r)
+{
+    const double n = (v * (1.0 / HALF_PI) + SHIFT) - SHIFT;
+    *r = ((v - n * PIO2_1) - n * PIO2_2) - n * PIO2_3;
+    return n;
+}
+
+// reduce v = n * rightAngle + r, |r| <= rightAngle/2, r in radians, returns n,
+//   for degree and gon this is exact as their right angle is integral
+inline double
+reduce_unit(double v, double rightAngle, double* r)
+{
+    const double n = (v * (1.0 / rightAngle) + SHIFT) - SHIFT;
+    *r = (v - n * rightAngle) * (HALF_PI / rightAngle);
+    return n;
+}
+
+/*
+ * reduce v = n * rightAngle + r, |r| <= rightAngle/2 and call
+ *   result(r in radians, quadrant(n)) for each value.
+ *   The quadrant is kept as double as SSE2 lacks 64 bit integer compares.
+ */
+template <typename Result, typename Fallback>
+void
+trig_block(const double* __restrict x, double* __restrict y, double rightAngle, Result result, Fallback fallback)
+{
+    if (rightAngle == HALF_PI) {
+        for (size_t i = 0; i < LEN; ++i) {
+            double r;
+            const double n = reduce_radian(x[i], &r);
+            y[i] = result(r, quadrant(n));
+        }
+    }
+    else {
+        for (size_t i = 0; i < LEN; ++i) {
+            double r;
+            const double n = reduce_unit(x[i], rightAngle, &r);
+            y[i] = result(r, quadrant(n));
+        }
+    }
+    const double limit = TRIG_QUADRANTS * rightAngle;
+    for (size_t i = 0; i < LEN; ++i) {
+        if (!(std::fabs(x[i]) < limit)) {
+            y[i] = fallback(to_radian(x[i], rightAngle));
+        }
+    }
+}
+
+// as trig_block for a single value, radians are left to libm
+template <typename Result, typename Fallback>
+double
+trig_value(double x, double rightAngle, Result result, Fallback fallback)
+{
+    if (rightAngle == HALF_PI
+     || !(std::fabs(x) < TRIG_QUADRANTS * rightAngle)) {
+        return fallback(to_radian(x, rightAngle));
+    }
+    double r;
+    const double n = reduce_unit(x, rightAngle, &r);
+    return result(r, quadrant(n));
+}
+
+// the sign is changed by 0 - v, so an exact zero
+//   e.g. for sin(180°) or cos(90°) stays positive
+inline double
+sin_result(double r, double q)
+{
+    const double v = std::fabs(q) == 1.0 ? cos_poly(r) : sin_poly(r);
+    return (q < 0.0 || q == 2.0) ? 0.0 - v : v;     // quadrant 2, 3
+}
+
+inline double
+cos_result(double r, double q)
+{
+    const double v = std::fabs(q) == 1.0 ? sin_poly(r) : cos_poly(r);
+    return (q > 0.5 || q < -1.5) ? 0.0 - v : v;     // quadrant 1, 2
+}
+
+// an exact pole e.g. tan(90°) gives +inf for both signs of r
+inline double
+tan_result(double r, double q)
+{
+    const double s = sin_poly(r);
+    const double c = cos_poly(r);
+    return std::fabs(q) == 1.0 ? c / (0.0 - s) : s / c;
+}
+
+constexpr double TAN_PI_12{0.2679491924311228};
+constexpr double SQRT3{1.7320508075688772};
+constexpr double PI_6{0.5235987755982989};
+constexpr double PI_6_LO{-5.360408832255455e-17};
+
+// atan in radians, by reducing to |u| <= tan(pi/12) using atan(1/t) and atan((t sqrt3 - 1)/(t + sqrt3))
+inline double
+atan_radian(double v)
+{
+    const double a = std::fabs(v);
+    const bool inverse = a > 1.0;
+    const double t = inverse ? 1.0 / a : a;
+    const bool shift = t > TAN_PI_12;
+    const double u = shift ? (t * SQRT3 - 1.0) / (t + SQRT3) : t;
+    const double z = u * u;
+    const double p = u + u * z * (-1.0 / 3.0 + z * (1.0 / 5.0 + z * (-1.0 / 7.0 + z * (1.0 / 9.0
+        + z * (-1.0 / 11.0 + z * (1.0 / 13.0 + z * (-1.0 / 15.0 + z * (1.0 / 17.0
+        + z * (-1.0 / 19.0 + z * (1.0 / 21.0 + z * (-1.0 / 23.0 + z * (1.0 / 25.0
+        + z * (-1.0 / 27.0 + z * (1.0 / 29.0 + z * (-1.0 / 31.0)))))))))))))));
+    double res = shift ? PI_6 + (PI_6_LO + p) : p;
+    res = inverse ? HALF_PI + (HALF_PI_LO - res) : res;
+    return std::copysign(res, v);
+}
+
+template <typename Radian>
+void
+arc_block(const double* __restrict x, double* __restrict y, double rightAngle, Radian radian)
+{
+    if (rightAngle == HALF_PI) {
+        for (size_t i = 0; i < LEN; ++i) {
+            y[i] = radian(x[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < LEN; ++i) {
+            y[i] = radian(x[i]) * rightAngle / HALF_PI;
+        }
+    }
+}
+
+}   // namespace
+
+void
+VectorMath::exp(std::span<const double> in, std::span<double> out)
+{
+    for_blocks(in, out, [] (const double* x, double* y) { exp_block(x, y); });
+}
+
+void
+VectorMath::log(std::span<const double> in, std::span<double> out)
+{
+    for_blocks(in, out, [] (const double* x, double* y) {
+        log_block(x, y
+                , [] (double e, double lm) { return e * LN2_HI + (e * LN2_LO + lm); }
+                , [] (double v) { return std::log(v); });
+    });
+}
+
+void
+VectorMath::log2(std::span<const double> in, std::span<double> out)
+{
+    for_blocks(in, out, [] (const double* x, double* y) {
+        log_block(x, y
+                , [] (double e, double lm) { return e + lm * LOG2E; }
+                , [] (double v) { return std::log2(v); });
+    });
+}
+
+void
+VectorMath::log10(std::span<const double> in, std::span<double> out)
+{
+    for_blocks(in, out, [] (const double* x, double* y) {
+        log_block(x, y
+                , [] (double e, double lm) { return e * LOG10_2_HI + (e * LOG10_2_LO + lm * LOG10E); }
+                , [] (double v) { return std::log10(v); });
+    });
+}
+
+void
+VectorMath::cbrt(std::span<const double> in, std::span<double> out)
+{
+    for_blocks(in, out, [] (const double* x, double* y) { cbrt_block(x, y); });
+}
+
+void
+VectorMath::sin(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        trig_block(x, y, rightAngle
+                , [] (double r, double q) { return sin_result(r, q); }
+                , [] (double v) { return std::sin(v); });
+    });
+}
+
+double
+VectorMath::sin(double val, double rightAngle)
+{
+    return trig_value(val, rightAngle
+            , [] (double r, double q) { return sin_result(r, q); }
+            , [] (double v) { return std::sin(v); });
+}
+
+void
+VectorMath::cos(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        trig_block(x, y, rightAngle
+                , [] (double r, double q) { return cos_result(r, q); }
+                , [] (double v) { return std::cos(v); });
+    });
+}
+
+double
+VectorMath::cos(double val, double rightAngle)
+{
+    return trig_value(val, rightAngle
+            , [] (double r, double q) { return cos_result(r, q); }
+            , [] (double v) { return std::cos(v); });
+}
+
+void
+VectorMath::tan(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        trig_block(x, y, rightAngle
+                , [] (double r, double q) { return tan_result(r, q); }
+                , [] (double v) { return std::tan(v); });
+    });
+}
+
+double
+VectorMath::tan(double val, double rightAngle)
+{
+    return trig_value(val, rightAngle
+            , [] (double r, double q) { return tan_result(r, q); }
+            , [] (double v) { return std::tan(v); });
+}
+
+void
+VectorMath::asin(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        arc_block(x, y, rightAngle, [] (double v) {
+            return atan_radian(v / std::sqrt((1.0 - v) * (1.0 + v)));
+        });
+    });
+}
+
+void
+VectorMath::acos(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        arc_block(x, y, rightAngle, [] (double v) {
+            return 2.0 * atan_radian(std::sqrt((1.0 - v) / (1.0 + v)));
+        });
+    });
+}
+
+void
+VectorMath::atan(std::span<const double> in, std::span<double> out, double rightAngle)
+{
+    for_blocks(in, out, [rightAngle] (const double* x, double* y) {
+        arc_block(x, y, rightAngle, [] (double v) { return atan_radian(v); });
+    });
+}
+
+double
+VectorMath::sum(std::span<const double> in)
+{
+    if (in.size() > BLOCK) {
+        size_t half = (in.size() / 2 + BLOCK - 1) / BLOCK * BLOCK;
+        return sum(in.first(half)) + sum(in.subspan(half));
+    }
+    constexpr size_t LANES{4};
+    std::array<double, LANES> lanes{};
+    size_t i = 0;
+    for (; i + LANES <= in.size(); i += LANES) {
+        for (size_t l = 0; l < LANES; ++l) {
+            lanes[l] += in[i + l];
+        }
+    }
+    for (; i < in.size(); ++i) {
+        lanes[0] += in[i];
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+double
+VectorMath::dot(std::span<const double> left, std::span<const double> right)
+{
+    if (left.size() > BLOCK) {
+        size_t half = (left.size() / 2 + BLOCK - 1) / BLOCK * BLOCK;
+        return dot(left.first(half), right.first(half)) + dot(left.subspan(half), right.subspan(half));
+    }
+    constexpr size_t LANES{4};
+    std::array<double, LANES> lanes{};
+    size_t i = 0;
+    for (; i + LANES <= left.size(); i += LANES) {
+        for (size_t l = 0; l < LANES; ++l) {
+            lanes[l] += left[i + l] * right[i + l];
+        }
+    }
+    for (; i < left.size(); ++i) {
+        lanes[0] += left[i] * right[i];
+    }
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+double
+VectorMath::min(std::span<const double> in)
+{
+    constexpr size_t LANES{4};
+    std::array<double, LANES> lanes;
+    lanes.fill(std::numeric_limits<double>::quiet_NaN());
+    size_t i = 0;
+    for (; i + LANES <= in.size(); i += LANES) {
+        for (size_t l = 0; l < LANES; ++l) {
+            lanes[l] = std::fmin(lanes[l], in[i + l]);
+        }
+    }
+    for (; i < in.size(); ++i) {
+        lanes[0] = std::fmin(lanes[0], in[i]);
+    }
+    return std::fmin(std::fmin(lanes[0], lanes[1]), std::fmin(lanes[2], lanes[3]));
+}
+
+double
+VectorMath::max(std::span<const double> in)
+{
+    constexpr size_t LANES{4};
+    std::array<double, LANES> lanes;
+    lanes.fill(std::numeric_limits<double>::quiet_NaN());
+    size_t i = 0;
+    for (; i + LANES <= in.size(); i += LANES) {
+        for (size_t l = 0; l < LANES; ++l) {
+            lanes[l] = std::fmax(lanes[l], in[i + l]);
+        }
+    }
+    for (; i < in.size(); ++i) {
+        lanes[0] = std::fmax(lanes[0], in[i]);
+    }
+    return std::fmax(std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]));
+}
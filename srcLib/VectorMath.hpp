@@ -0,0 +1,69 @@
+/* -*- Mode: c++; c-basic-offset: 4; tab-width: 4;  coding: utf-8; -*-  */
+/*
+ * Copyright (C) 2026 RPf
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <span>
+#include <cstddef>
+
+/*
+ * elementary functions for blocks of values,
+ *   the kernels are plain fixed length loops without branches
+ *   so the compiler is able to vectorize them (SSE2 on x86-64,
+ *   wider if enabled by -march).
+ *   Arguments a kernel can't reduce accurately
+ *   (e.g. huge, subnormal, non finite) are passed to libm.
+ *   Max. error measured against libm in units of the last place:
+ *     exp, log 1; log2, log10, sin, cos 2; cbrt, atan, asin, acos 3; tan 4.
+ *   The loops only vectorize if the compiler may ignore errno
+ *   and floating point exceptions (see meson.build).
+ *   Input and output may be the same range.
+ */
+class VectorMath
+{
+public:
+    static void exp(std::span<const double> in, std::span<double> out);
+    static void log(std::span<const double> in, std::span<double> out);
+    static void log2(std::span<const double> in, std::span<double> out);
+    static void log10(std::span<const double> in, std::span<double> out);
+    static void cbrt(std::span<const double> in, std::span<double> out);
+    // angles use the unit given by the size of a right angle e.g. 90 for degree,
+    //   degree and gon are reduced exactly before converting to radians
+    static void sin(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    static void cos(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    static void tan(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    // a single value, the same as by the block version for degree and gon,
+    //   in radians libm is used
+    static double sin(double val, double rightAngle = RIGHT_ANGLE);
+    static double cos(double val, double rightAngle = RIGHT_ANGLE);
+    static double tan(double val, double rightAngle = RIGHT_ANGLE);
+    static void asin(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    static void acos(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    static void atan(std::span<const double> in, std::span<double> out, double rightAngle = RIGHT_ANGLE);
+    // pairwise above BLOCK, so the rounding error grows
+    //   with the logarithm of the count, not the count
+    static double sum(std::span<const double> in);
+    // sum of the products, pairwise as sum
+    static double dot(std::span<const double> left, std::span<const double> right);
+    // NaN values are ignored, as by fmin and fmax, empty gives NaN
+    static double min(std::span<const double> in);
+    static double max(std::span<const double> in);
+
+    static constexpr double RIGHT_ANGLE{1.57079632679489661923};   // in radians
+    static constexpr size_t BLOCK{32};
+};
@@ -18,14 +18,28 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <cstdlib>
+#include <cmath>
 #include <psc_format.hpp>
 #include <psc_Files.hpp>
 #include <tuple>
+#include <functional>
+#include <thread>
+#include <algorithm>
+#include <numbers>
+#include <bit>
 
 #include "CalcppApp.hpp"
 #include "calc_test.hpp"
 #include "Syntax.hpp"
+#include "VectorMath.hpp"
+#include "Evaluator.hpp"
+#include "EvalFrame.hpp"
+#include "PlotSampler.hpp"
+#include "BoundForm.hpp"
+#include "BatchEval.hpp"
+#include "EvalSession.hpp"
 #include "Unit.hpp"
 #include "calcpp_config.h"
 
@@ -74,6 +88,1390 @@ testEvalBraced()
     return std::abs(res - 35.5) < VALUE_LIMIT;
 }
 
+// compile once, evaluate repeatedly
+bool
+testCompile()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    Glib::ustring expr{"-(3+4.1)*5-2^3"};
+    auto program = testEval->compile(syntax.parse(expr));
+    if (program->get_max_depth() != 1) {     // folded by the optimizer
+        std::cout << "testCompile depth " << program->get_max_depth() << " expected 1" << std::endl;
+        return false;
+    }
+    for (int i = 0; i < 2; ++i) {
+        double res = testEval->eval(program);
+        if (std::abs(res - (-43.5)) >= VALUE_LIMIT) {
+            std::cout << "testCompile " << res << " expected -43.5" << std::endl;
+            return false;
+        }
+    }
+    try {
+        Glib::ustring unbalanced{"3+"};
+        testEval->compile(syntax.parse(unbalanced));
+        std::cout << "testCompile no error for unbalanced" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// variables are resolved to slots when compiling
+bool
+testVariables()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    Glib::ustring assign{"a = 3"};
+    auto assignProgram = testEval->compile(syntax.parse(assign));
+    Glib::ustring expr{"a * 2 + a"};
+    auto program = testEval->compile(syntax.parse(expr));
+    try {
+        testEval->eval(program);
+        std::cout << "testVariables no error for undefined variable" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    testEval->eval(assignProgram);
+    double res = testEval->eval(program);
+    if (std::abs(res - 9.0) >= VALUE_LIMIT) {
+        std::cout << "testVariables " << res << " expected 9" << std::endl;
+        return false;
+    }
+    testEval->set_variable("a", 4.0);
+    res = testEval->eval(program);
+    if (std::abs(res - 12.0) >= VALUE_LIMIT) {
+        std::cout << "testVariables " << res << " expected 12" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// parameters are bound on evaluation, and do not touch variables
+bool
+testParams()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("x", 100.0);
+    testEval->set_variable("a", 1.0);
+    Glib::ustring expr{"x^2+a"};
+    auto program = testEval->compile(syntax.parse(expr), {"x"});
+    for (double x : {-1.0, 2.0, 3.0}) {
+        double res = testEval->eval(program, std::span<const double>(&x, 1));
+        if (std::abs(res - (x * x + 1.0)) >= VALUE_LIMIT) {
+            std::cout << "testParams x " << x << " got " << res << std::endl;
+            return false;
+        }
+    }
+    double x{};
+    if (!testEval->get_variable("x", &x) || x != 100.0) {
+        std::cout << "testParams variable x changed " << x << std::endl;
+        return false;
+    }
+    try {
+        testEval->eval(program);
+        std::cout << "testParams no error for missing parameter" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// batch evaluation has to match the scalar evaluation
+bool
+testBatch()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("a", 0.5);
+    Glib::ustring expr{"-x*x - 3*x + a/x + x^a % 3"};
+    auto program = testEval->compile(syntax.parse(expr), {"x"});
+    std::vector<double> in(1000);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = 0.1 + static_cast<double>(i) * 0.37;
+    }
+    std::vector<double> out(in.size());
+    testEval->eval_batch(program, in, out);
+    for (size_t i = 0; i < in.size(); ++i) {
+        double res = testEval->eval(program, std::span<const double>(&in[i], 1));
+        if (std::abs(res - out[i]) > std::abs(res) * VALUE_LIMIT) {
+            std::cout << "testBatch x " << in[i] << " got " << out[i] << " expected " << res << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// single pass lexing, with unicode operators and a locale decimal point
+bool
+testLexer()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("π", G_PI);
+    testEval->set_variable("ln2", 0.5);
+    Glib::ustring expr{"\tπ×2 − 3÷4\n+ ln2 + 1.5e1 + .5"};
+    double res = testEval->eval(syntax.parse(expr));
+    double expect = G_PI * 2.0 - 0.75 + 0.5 + 15.0 + 0.5;
+    if (std::abs(res - expect) > VALUE_LIMIT) {
+        std::cout << "testLexer " << expr << " got " << res << " expected " << expect << std::endl;
+        return false;
+    }
+    std::string sum{"1"};
+    for (int i = 1; i < 100000; ++i) {
+        sum += " + 1";
+    }
+    Glib::ustring longExpr{sum};
+    res = testEval->eval(syntax.parse(longExpr));
+    if (res != 100000.0) {
+        std::cout << "testLexer long sum got " << res << std::endl;
+        return false;
+    }
+    Syntax commaSyntax(std::make_shared<CommaFormat>(), testEval);
+    Glib::ustring comma{"1,5*2 + 2,5e1 + ,25"};
+    res = testEval->eval(commaSyntax.parse(comma));
+    if (std::abs(res - 28.25) > VALUE_LIMIT) {
+        std::cout << "testLexer " << comma << " got " << res << " expected 28.25" << std::endl;
+        return false;
+    }
+    try {
+        Glib::ustring invalid{"2 $ 3"};
+        syntax.parse(invalid);
+        std::cout << "testLexer no error for invalid char" << std::endl;
+        return false;
+    }
+    catch (const LexingError& err) {
+    }
+    return true;
+}
+
+// operators are bound by precedence into a tree, negation is recognized after =
+bool
+testParser()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    Glib::ustring expr{"2^-3^2*(4-1)-5-6"};
+    auto ast = syntax.parse(expr);
+    Glib::ustring expect{"(- (- (* (^ 2 (u- (^ 3 2))) (- 4 1)) 5) 6)"};
+    if (ast.show() != expect) {
+        std::cout << "testParser got \"" << ast.show() << "\" expected \"" << expect << "\"" << std::endl;
+        return false;
+    }
+    Glib::ustring assign{"a=-3"};
+    testEval->eval(syntax.parse(assign));
+    double val{};
+    if (!testEval->get_variable("a", &val)
+      || val != -3.0) {
+        std::cout << "testParser " << assign << " got " << val << std::endl;
+        return false;
+    }
+    Glib::ustring call{"sqrt(16)+2*sqrt 4+5"};      // without parenthesis the rest is the argument
+    val = testEval->eval(syntax.parse(call));
+    if (val != 10.0) {
+        std::cout << "testParser " << call << " got " << val << " expected 10" << std::endl;
+        return false;
+    }
+    std::string nested(Syntax::NESTING_LIMIT + 1, '(');
+    nested += "1";
+    nested += std::string(Syntax::NESTING_LIMIT + 1, ')');
+    for (std::string invalid : {std::string("(1+2"), std::string("1+2)"), std::string("1=2"), std::string("1;2"), std::string(), std::string("sqrt(1;2)"), nested}) {
+        try {
+            Glib::ustring text{invalid};
+            testEval->compile(syntax.parse(text));
+            std::cout << "testParser no error for \"" << invalid.substr(0, 10) << "\"" << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    return true;
+}
+
+// the evaluator works without any gui
+bool
+testEvaluator()
+{
+    Evaluator evaluator;
+    evaluator.set_angle_conv(AngleConversion::get_conversion("deg"));
+    double res = evaluator.evaluate("a = sin(90) + 2 * π");
+    if (std::abs(res - (1.0 + 2.0 * G_PI)) > VALUE_LIMIT) {
+        std::cout << "testEvaluator got " << res << std::endl;
+        return false;
+    }
+    auto variables = evaluator.get_variable_map();
+    if (variables.size() != 1
+     || variables.begin()->first != "a") {
+        std::cout << "testEvaluator expected just variable a got " << variables.size() << std::endl;
+        return false;
+    }
+    try {
+        evaluator.evaluate("e = 3");
+        std::cout << "testEvaluator no error for assignment to constant" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// one output line for each input line, errors reported by line
+bool
+testBatchEval()
+{
+    BatchEval batchEval;
+    std::istringstream in{"a = 3\n\n  a * 2\r\n1 +\nsqrt(a + 6)"};
+    std::ostringstream out;
+    std::ostringstream err;
+    size_t failed = batchEval.run(in, out, err);
+    auto format = batchEval.get_evaluator()->get_output_format();
+    std::string expect = format->format(3.0) + "\n\n"
+                       + format->format(6.0) + "\n\n"
+                       + format->format(3.0) + "\n";
+    if (failed != 1
+     || out.str() != expect
+     || !err.str().starts_with("Line 4:")) {
+        std::cout << "testBatchEval failed " << failed
+                  << " out \"" << out.str() << "\" err \"" << err.str() << "\"" << std::endl;
+        return false;
+    }
+    if (batchEval.set_output_format("none")
+     || !batchEval.set_output_format("hex")) {
+        std::cout << "testBatchEval format selection" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// pipelined requests, partial frames and the compiled cache
+bool
+testEvalSession()
+{
+    EvalStats stats;
+    EvalSession session(&stats);
+    std::string requests;
+    EvalSession::frame('E', "a = 0.5", requests);
+    EvalSession::frame('E', "a * 3", requests);
+    EvalSession::frame('E', "a * 3", requests);
+    EvalSession::frame('E', "1 +", requests);
+    EvalSession::frame('S', "", requests);
+    std::string out;
+    auto split = requests.size() - 3;    // stats frame arrives later
+    if (!session.receive(std::string_view(requests).substr(0, split), out)
+     || !session.receive(std::string_view(requests).substr(split), out)) {
+        std::cout << "testEvalSession protocol error" << std::endl;
+        return false;
+    }
+    std::string expect;
+    EvalSession::frame('R', "0.5", expect);
+    EvalSession::frame('R', "1.5", expect);
+    EvalSession::frame('R', "1.5", expect);
+    if (!out.starts_with(expect)
+     || out[expect.size() + EvalSession::HEADER_SIZE] != 'E'
+     || stats.requests != 4
+     || stats.errors != 1
+     || stats.cacheHits != 1
+     || out.find("requests 4 errors 1 cache_hits 1") == std::string::npos) {
+        std::cout << "testEvalSession got " << out.size() << " bytes, stats " << stats.show() << std::endl;
+        return false;
+    }
+    std::string invalid{"\xff\xff\xff\xff"};
+    if (session.receive(invalid, out)) {
+        std::cout << "testEvalSession no error for invalid length" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// a compiled program evaluated concurrently, each thread with its frame
+bool
+testFrames()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("a", 2.0);
+    Glib::ustring expr{"a * x + 1"};
+    auto program = testEval->compile(syntax.parse(expr), {"x"});
+    Glib::ustring assign{"a = 5"};
+    auto assignProgram = testEval->compile(syntax.parse(assign));
+    constexpr size_t THREADS{4};
+    constexpr size_t COUNT{10000};
+    std::vector<std::unique_ptr<EvalFrame>> frames;
+    for (size_t t = 0; t < THREADS; ++t) {
+        frames.emplace_back(std::make_unique<EvalFrame>(*testEval));
+        frames.back()->detach();
+    }
+    std::vector<double> sums(THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < COUNT; ++i) {
+                double x = static_cast<double>(i);
+                sums[t] += frames[t]->eval(*program, std::span<const double>(&x, 1));
+            }
+        });
+    }
+    testEval->eval(assignProgram);      // detached frames will not see this
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double expect = static_cast<double>(COUNT * (COUNT - 1)) + static_cast<double>(COUNT);
+    for (auto sum : sums) {
+        if (sum != expect) {
+            std::cout << "testFrames sum " << sum << " expected " << expect << std::endl;
+            return false;
+        }
+    }
+    EvalFrame local(*testEval);
+    Glib::ustring localAssign{"a = 7"};
+    local.eval(*testEval->compile(syntax.parse(localAssign)));
+    double val{};
+    testEval->get_variable("a", &val);
+    double x{1.0};
+    if (val != 5.0
+     || local.eval(*program, std::span<const double>(&x, 1)) != 8.0) {
+        std::cout << "testFrames local binding a " << val << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// the chunks sampled in parallel are gathered in order
+bool
+testPlotSampler()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("a", 3.0);
+    Glib::ustring expr{"a * x * x"};
+    PlotSampler sampler(*testEval, testEval->compile(syntax.parse(expr), {"x"}));
+    constexpr size_t COUNT{PlotSampler::CHUNK_MIN * 4 + 1};
+    auto samples = sampler.sample(-2.0, 2.0, COUNT).get();
+    if (samples.x.size() != COUNT
+     || samples.y.size() != COUNT
+     || samples.x.front() != -2.0
+     || samples.x.back() != 2.0) {
+        std::cout << "testPlotSampler size " << samples.x.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < COUNT; ++i) {
+        double x = samples.x[i];
+        if (std::abs(samples.y[i] - 3.0 * x * x) > 1e-12) {
+            std::cout << "testPlotSampler x " << x << " y " << samples.y[i] << std::endl;
+            return false;
+        }
+    }
+    double between = (samples.x[10] + samples.x[11]) / 2.0;
+    if (!samples.contains(between)
+     || samples.contains(2.5)
+     || std::abs(samples.interpolate(between) - 3.0 * between * between) > 1e-4) {
+        std::cout << "testPlotSampler interpolate " << samples.interpolate(between) << std::endl;
+        return false;
+    }
+    Glib::ustring undefined{"b * x"};
+    PlotSampler failing(*testEval, testEval->compile(syntax.parse(undefined), {"x"}));
+    try {
+        failing.sample(0.0, 1.0, 10).get();
+        std::cout << "testPlotSampler no error for " << undefined << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// flat parts stay at the coarse grid with the midpoints that tested them,
+//   the pole of 1/x is refined and marked
+bool
+testAdaptiveSampling()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    constexpr size_t BUDGET{800};
+    constexpr size_t START{BUDGET / PlotSampler::ADAPTIVE_START};
+    Glib::ustring line{"2 * x + 1"};
+    PlotSampler lineSampler(*testEval, testEval->compile(syntax.parse(line), {"x"}));
+    auto lineSamples = lineSampler.sample_adaptive(-1.0, 1.0, BUDGET).get();
+    if (lineSamples.x.size() != 2 * START - 1) {
+        std::cout << "testAdaptiveSampling " << line << " size " << lineSamples.x.size() << std::endl;
+        return false;
+    }
+    Glib::ustring pole{"1 / x"};
+    PlotSampler poleSampler(*testEval, testEval->compile(syntax.parse(pole), {"x"}));
+    auto samples = poleSampler.sample_adaptive(-1.0, 1.3, BUDGET).get();
+    if (samples.x.size() > BUDGET + 1
+     || !std::is_sorted(samples.x.begin(), samples.x.end())) {
+        std::cout << "testAdaptiveSampling " << pole << " size " << samples.x.size() << std::endl;
+        return false;
+    }
+    size_t nearPole{};
+    size_t gaps{};
+    for (size_t i = 0; i < samples.x.size(); ++i) {
+        if (std::isnan(samples.y[i])) {
+            ++gaps;
+            if (std::abs(samples.x[i]) > 1e-3) {
+                std::cout << "testAdaptiveSampling gap at " << samples.x[i] << std::endl;
+                return false;
+            }
+        }
+        else if (std::abs(samples.y[i] - 1.0 / samples.x[i]) > 1e-12) {
+            std::cout << "testAdaptiveSampling x " << samples.x[i] << " y " << samples.y[i] << std::endl;
+            return false;
+        }
+        if (std::abs(samples.x[i]) < 0.1) {     // less than 5% of the range
+            ++nearPole;
+        }
+    }
+    if (gaps != 1
+     || nearPole < samples.x.size() / 4) {
+        std::cout << "testAdaptiveSampling gaps " << gaps << " near pole " << nearPole << std::endl;
+        return false;
+    }
+    // the enclosure finds a spike narrower than the coarse grid
+    Glib::ustring spike{"x + 1 / (1 + 100000000 * (x - 0.3071)^2)"};
+    PlotSampler spikeSampler(*testEval, testEval->compile(syntax.parse(spike), {"x"}));
+    auto spikeSamples = spikeSampler.sample_adaptive(-1.0, 1.3, BUDGET).get();
+    double peak{};
+    for (size_t i = 0; i < spikeSamples.x.size(); ++i) {
+        peak = std::max(peak, spikeSamples.y[i] - spikeSamples.x[i]);
+    }
+    if (peak < 0.9) {
+        std::cout << "testAdaptiveSampling missed " << spike << std::endl;
+        return false;
+    }
+    // proven constant, so the grid is enough
+    Glib::ustring flat{"count(x) * 0 + 1"};
+    PlotSampler flatSampler(*testEval, testEval->compile(syntax.parse(flat), {"x"}));
+    size_t before = testEval->get_count();
+    flatSampler.sample_adaptive(-1.0, 1.3, BUDGET).get();
+    if (testEval->get_count() - before != START) {
+        std::cout << "testAdaptiveSampling flat " << testEval->get_count() - before << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// panning reuses the tiles, a change of a used variable drops them
+bool
+testSampleTiles()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_variable("a", 2.0);
+    testEval->set_variable("b", 1.0);
+    Glib::ustring expr{"a * count(x)"};
+    PlotSampler sampler(*testEval, testEval->compile(syntax.parse(expr), {"x"}));
+    constexpr size_t BUDGET{1024};
+    auto samples = sampler.sample_tiles(0.0, 8.0, BUDGET).get();
+    size_t first = testEval->get_count();
+    if (!samples.contains(0.0)
+     || !samples.contains(8.0)
+     || !std::is_sorted(samples.x.begin(), samples.x.end())
+     || std::adjacent_find(samples.x.begin(), samples.x.end()) != samples.x.end()
+     || samples.interpolate(3.3) != 6.6) {
+        std::cout << "testSampleTiles samples " << samples.x.size()
+                  << " at 3.3 " << samples.interpolate(3.3) << std::endl;
+        return false;
+    }
+    sampler.sample_tiles(1.0, 9.0, BUDGET).get();     // one new tile
+    size_t panned = testEval->get_count() - first;
+    if (panned == 0
+     || panned > first / 4) {
+        std::cout << "testSampleTiles first " << first << " panned " << panned << std::endl;
+        return false;
+    }
+    testEval->set_variable("b", 3.0);                   // not used
+    size_t unchanged = testEval->get_count();
+    sampler.sample_tiles(1.0, 9.0, BUDGET).get();
+    testEval->set_variable("a", 3.0);
+    if (testEval->get_count() != unchanged
+     || sampler.sample_tiles(1.0, 9.0, BUDGET).get().interpolate(3.3) != 3.0 * 3.3
+     || testEval->get_count() == unchanged) {
+        std::cout << "testSampleTiles not updated " << testEval->get_count() << std::endl;
+        return false;
+    }
+    // a cancelled sampling ends, and leaves no incomplete tiles
+    auto cancelled = sampler.sample_tiles(100.0, 108.0, BUDGET);
+    sampler.cancel();
+    cancelled.get();
+    auto resampled = sampler.sample_tiles(100.0, 108.0, BUDGET).get();
+    if (!resampled.contains(100.0)
+     || !resampled.contains(108.0)
+     || std::abs(resampled.interpolate(103.3) - 3.0 * 103.3) > 1e-9) {
+        std::cout << "testSampleTiles cancelled " << resampled.x.size() << std::endl;
+        return false;
+    }
+    // variables used just within a form or as list
+    testEval->set_variable("c", 1.0);
+    testEval->set_list("l", std::vector<double>{1.0, 2.0});
+    Glib::ustring inner{"x + sum(c * k; k; 1; 2) + sum(l)"};
+    PlotSampler innerSampler(*testEval, testEval->compile(syntax.parse(inner), {"x"}));
+    innerSampler.sample_tiles(0.0, 8.0, BUDGET).get();
+    testEval->set_variable("c", 2.0);
+    auto changed = innerSampler.sample_tiles(0.0, 8.0, BUDGET).get().interpolate(3.5);
+    testEval->set_list("l", std::vector<double>{1.0, 2.0, 3.0});
+    auto listChanged = innerSampler.sample_tiles(0.0, 8.0, BUDGET).get().interpolate(3.5);
+    if (std::abs(changed - (3.5 + 6.0 + 3.0)) > 1e-9
+     || std::abs(listChanged - (3.5 + 6.0 + 6.0)) > 1e-9) {
+        std::cout << "testSampleTiles inner " << changed << " list " << listChanged << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// the enclosures have to contain the point values
+bool
+testInterval()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    EvalFrame frame(*evaluator);
+    std::vector<std::string> exprs{
+         "x^2 - 3*x", "x^-3", "sqrt(x)", "log(x)", "exp(x) / (1 + x)", "sin(3*x)", "cos(x)"
+        ,"tan(x)", "asin(x / 4)", "atan(x)", "abs(x) - x", "x % 1.5", "2^x", "x^0.5"};
+    std::vector<Interval> ranges{{-3.0, 2.5}, {0.5, 1.25}, {-0.1, 0.1}, {1.0, 1.0}, {-4.0, -3.0}};
+    for (auto& text : exprs) {
+        Glib::ustring expr{text};
+        auto program = evaluator->compile(syntax.parse(expr), {"x"});
+        for (auto& range : ranges) {
+            auto enclosure = frame.eval_interval(*program, std::span<const Interval>(&range, 1));
+            constexpr int STEPS{1000};
+            for (int i = 0; i <= STEPS; ++i) {
+                double x = range.lo + range.width() * i / STEPS;
+                double y = frame.eval(*program, std::span<const double>(&x, 1));
+                if (!std::isnan(y)
+                 && !enclosure.contains(y)) {
+                    std::cout << "testInterval " << text << " at " << x << " = " << y
+                              << " not in [" << enclosure.lo << ", " << enclosure.hi << "]" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    struct Check {
+        const char* expr;
+        Interval range;
+        Interval expect;    // with a tolerance of 1e-9
+    };
+    std::vector<Check> checks{
+         {"x^2", {-1.0, 2.0}, {0.0, 4.0}}
+        ,{"sqrt(x)", {-1.0, 4.0}, {0.0, 2.0}}
+        ,{"sin(x)", {0.0, 3.0}, {0.0, 1.0}}
+        ,{"cos(x)", {1.0, 7.0}, {-1.0, 1.0}}
+    };
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        auto program = evaluator->compile(syntax.parse(expr), {"x"});
+        auto enclosure = frame.eval_interval(*program, std::span<const Interval>(&check.range, 1));
+        if (std::abs(enclosure.lo - check.expect.lo) > 1e-9
+         || std::abs(enclosure.hi - check.expect.hi) > 1e-9) {
+            std::cout << "testInterval " << check.expr
+                      << " [" << enclosure.lo << ", " << enclosure.hi << "]" << std::endl;
+            return false;
+        }
+    }
+    Glib::ustring pole{"1 / x"};
+    Glib::ustring outside{"log(x)"};
+    Interval range(-1.0, 1.0);
+    Interval negative(-2.0, -1.0);
+    if (frame.eval_interval(*evaluator->compile(syntax.parse(pole), {"x"}), std::span<const Interval>(&range, 1)).is_bounded()
+     || !frame.eval_interval(*evaluator->compile(syntax.parse(outside), {"x"}), std::span<const Interval>(&negative, 1)).is_empty()) {
+        std::cout << "testInterval pole or domain" << std::endl;
+        return false;
+    }
+    // the conversion of degree and gon may round, the enclosures have to hold anyway
+    for (auto unit : {"deg", "gon"}) {
+        evaluator->set_angle_conv(AngleConversion::get_conversion(unit));
+        double rightAngle = evaluator->get_right_angle();
+        EvalFrame angleFrame(*evaluator);
+        for (auto text : {"sin(x)", "cos(x)", "tan(x)"}) {
+            Glib::ustring expr{text};
+            auto program = evaluator->compile(syntax.parse(expr), {"x"});
+            for (int i = -4; i <= 4; ++i) {
+                double at = i * rightAngle;
+                for (auto& around : {Interval(at, at), Interval(at - 1.0, at), Interval(at, at + 1.0)}) {
+                    auto enclosure = angleFrame.eval_interval(*program, std::span<const Interval>(&around, 1));
+                    for (double x : {around.lo, around.hi}) {
+                        double y = angleFrame.eval(*program, std::span<const double>(&x, 1));
+                        if (std::isfinite(y)
+                         && !enclosure.contains(y)) {
+                            std::cout << "testInterval " << text << " " << unit << " at " << x << " = " << y
+                                      << " not in [" << enclosure.lo << ", " << enclosure.hi << "]" << std::endl;
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    evaluator->set_angle_conv(AngleConversion::get_conversion("rad"));
+    // an unbounded argument has to end, and may not overflow the count of factors
+    Glib::ustring unbounded{"fac(1 / x)"};
+    Interval positive(0.0, 0.5);
+    auto factorial = evaluator->compile(syntax.parse(unbounded), {"x"});
+    auto poleFactorial = frame.eval_interval(*factorial, std::span<const Interval>(&range, 1));
+    auto largeFactorial = frame.eval_interval(*factorial, std::span<const Interval>(&positive, 1));
+    if (poleFactorial.is_bounded()
+     || largeFactorial.is_bounded()
+     || !largeFactorial.contains(2.0)) {
+        std::cout << "testInterval unbounded factorial" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// the derivatives by dual numbers match the analytic ones
+bool
+testDual()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    struct Check {
+        const char* expr;
+        double (*derivative)(double x);
+    };
+    std::vector<Check> checks{
+         {"x^3 - 2*x", [] (double x) { return 3.0 * x * x - 2.0; }}
+        ,{"x^-2 + 5", [] (double x) { return -2.0 / (x * x * x); }}
+        ,{"sin(x) * exp(x)", [] (double x) { return (std::cos(x) + std::sin(x)) * std::exp(x); }}
+        ,{"sqrt(x) / x", [] (double x) { return -0.5 / (x * std::sqrt(x)); }}
+        ,{"x^x", [] (double x) { return std::pow(x, x) * (std::log(x) + 1.0); }}
+        ,{"log(x^2 + 1)", [] (double x) { return 2.0 * x / (x * x + 1.0); }}
+        ,{"atan(x) - acos(x / 4)", [] (double x) { return 1.0 / (1.0 + x * x) + 1.0 / std::sqrt(16.0 - x * x); }}
+        ,{"tan(x) + abs(x - 1)", [] (double x) { return 1.0 / (std::cos(x) * std::cos(x)) + (x > 1.0 ? 1.0 : -1.0); }}
+        ,{"2^x", [] (double x) { return std::pow(2.0, x) * std::numbers::ln2; }}
+        ,{"x % 1.5", [] (double x) { return 1.0; }}
+    };
+    EvalFrame frame(*evaluator);
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        auto program = evaluator->compile(syntax.parse(expr), {"x"});
+        for (double x : {0.3, 0.7, 1.3, 2.9}) {
+            Dual arg(x, 1.0);
+            auto result = frame.eval_dual(*program, std::span<const Dual>(&arg, 1));
+            double expect = check.derivative(x);
+            if (std::abs(result.val - frame.eval(*program, std::span<const double>(&x, 1))) > 1e-12
+             || std::abs(result.der - expect) > 1e-9 * std::max(std::abs(expect), 1.0)) {
+                std::cout << "testDual " << check.expr << " at " << x
+                          << " derivative " << result.der << " expected " << expect << std::endl;
+                return false;
+            }
+        }
+    }
+    // the angle conversion is part of the derivative
+    evaluator->set_angle_conv(AngleConversion::get_conversion("deg"));
+    Glib::ustring sine{"sin(x)"};
+    auto program = evaluator->compile(syntax.parse(sine), {"x"});
+    EvalFrame degree(*evaluator);
+    Dual arg(60.0, 1.0);
+    double expect = 0.5 * G_PI / 180.0;
+    if (std::abs(degree.eval_dual(*program, std::span<const Dual>(&arg, 1)).der - expect) > 1e-12) {
+        std::cout << "testDual degree " << degree.eval_dual(*program, std::span<const Dual>(&arg, 1)).der << std::endl;
+        return false;
+    }
+    // the sampler gives f' for derivative
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax testSyntax(testFormat, testEval);
+    Glib::ustring square{"x^2"};
+    PlotSampler sampler(*testEval, testEval->compile(testSyntax.parse(square), {"x"}), true);
+    auto samples = sampler.sample_adaptive(-1.0, 1.0, 256).get();
+    for (size_t i = 0; i < samples.x.size(); ++i) {
+        if (std::abs(samples.y[i] - 2.0 * samples.x[i]) > 1e-12) {
+            std::cout << "testDual sample " << samples.x[i] << " " << samples.y[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+testSolve()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    struct Check {
+        const char* expr;
+        double root;
+    };
+    std::vector<Check> checks{
+         {"solve(x^2 - 2; x; 0; 2)", std::numbers::sqrt2}
+        ,{"solve(cos(x) - x; x; 0; 1)", 0.7390851332151607}
+        ,{"solve(x^3 - x; x; 2; -2)", -1.0}                 // the smallest
+        ,{"solve((x - 1)^2; x; 0; 3)", 1.0}                 // without sign change
+        ,{"solve(1/(x - 1.5) + 2; x; 1; 2)", 1.0}           // not the pole
+        ,{"solve(solve(t^2 - a; t; 0; 9) - 2; a; 0; 9)", 4.0}
+    };
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        double root = evaluator->eval(syntax.parse(expr));
+        if (std::abs(root - check.root) > 1e-5) {
+            std::cout << "testSolve " << check.expr << " got " << root << " expected " << check.root << std::endl;
+            return false;
+        }
+    }
+    // all roots, the bound variable does not touch the variables
+    Glib::ustring sine{"sin(x)"};
+    FormSolve solve(evaluator->compile(syntax.parse(sine), {"x"}));
+    EvalFrame frame(*evaluator);
+    auto roots = solve.roots(-1.0, 10.0, {}, frame);
+    std::vector<double> expect{0.0, G_PI, 2.0 * G_PI, 3.0 * G_PI};
+    if (roots.size() != expect.size()
+     || !std::equal(roots.begin(), roots.end(), expect.begin(),
+            [] (double root, double exp) { return std::abs(root - exp) < 1e-12; })) {
+        std::cout << "testSolve roots " << roots.size() << std::endl;
+        return false;
+    }
+    double val;
+    if (evaluator->get_variable("x", &val)) {
+        std::cout << "testSolve x was set " << val << std::endl;
+        return false;
+    }
+    // the body sees the parameters, the variable hides one of the same name
+    Glib::ustring sqrt{"solve(t^2 - a; t; 0; a) + solve(x - 1; x; 0; 2)"};
+    auto program = evaluator->compile(syntax.parse(sqrt), {"a", "x"});
+    std::array<double, 2> params{9.0, 5.0};
+    if (std::abs(evaluator->eval(program, params) - 4.0) > 1e-12) {
+        std::cout << "testSolve params " << evaluator->eval(program, params) << std::endl;
+        return false;
+    }
+    Glib::ustring inverse{"solve(t^3 - x; t; -3; 3)"};
+    program = evaluator->compile(syntax.parse(inverse), {"x"});
+    std::vector<double> input{-8.0, -1.0, 0.5, 8.0};
+    std::vector<double> output(input.size());
+    evaluator->eval_batch(program, input, output);
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (std::abs(output[i] - std::cbrt(input[i])) > 1e-12) {
+            std::cout << "testSolve batch " << input[i] << " " << output[i] << std::endl;
+            return false;
+        }
+    }
+    for (auto fail : {"solve(x^2 + 1; x; -2; 2)", "solve(x; x; 1)", "solve(x; 2; 0; 1)"}) {
+        Glib::ustring expr{fail};
+        try {
+            evaluator->eval(syntax.parse(expr));
+            std::cout << "testSolve no error for " << fail << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    return true;
+}
+
+bool
+testIntegrate()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    struct Check {
+        const char* expr;
+        double integral;
+    };
+    std::vector<Check> checks{
+         {"integrate(x^2; x; 0; 3)", 9.0}
+        ,{"integrate(sin(x); x; 0; acos(-1))", 2.0}
+        ,{"integrate(x; x; 2; 0)", -2.0}
+        ,{"integrate(1/sqrt(x); x; 0; 1)", 2.0}            // not evaluated at 0
+        ,{"integrate(exp(-x^2); x; -1/0; 1/0)", std::sqrt(G_PI)}
+        ,{"integrate(1/x^2; x; 1; 1/0)", 1.0}
+        ,{"integrate(exp(x); x; -1/0; 0)", 1.0}
+        ,{"integrate(integrate(x*y; y; 0; x); x; 0; 2)", 2.0}
+    };
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        double integral = evaluator->eval(syntax.parse(expr));
+        if (std::abs(integral - check.integral) > 1e-9) {
+            std::cout << "testIntegrate " << check.expr << " got " << integral
+                      << " expected " << check.integral << std::endl;
+            return false;
+        }
+    }
+    // with the parameter in batch, the bound variable does not set x
+    Glib::ustring scaled{"integrate(t * x; t; 0; 1)"};
+    auto program = evaluator->compile(syntax.parse(scaled), {"x"});
+    std::vector<double> input{-2.0, 0.5, 3.0};
+    std::vector<double> output(input.size());
+    evaluator->eval_batch(program, input, output);
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (std::abs(output[i] - input[i] / 2.0) > 1e-12) {
+            std::cout << "testIntegrate batch " << input[i] << " " << output[i] << std::endl;
+            return false;
+        }
+    }
+    // many jumps refine enough parts at once to be evaluated in parallel
+    Glib::ustring saw{"integrate(x % 0.005; x; 0; 1)"};
+    evaluator->set_integration_limit(100000);
+    double sawIntegral = evaluator->eval(syntax.parse(saw));
+    if (std::abs(sawIntegral - 0.0025) > 1e-9) {
+        std::cout << "testIntegrate saw " << sawIntegral << std::endl;
+        return false;
+    }
+    // the limit ends refinement early
+    Glib::ustring root{"integrate(sqrt(x); x; 0; 1)"};
+    evaluator->set_integration_limit(1);
+    double coarse = evaluator->eval(syntax.parse(root));
+    evaluator->set_integration_limit(BaseEval::INTEGRATION_LIMIT);
+    double fine = evaluator->eval(syntax.parse(root));
+    if (std::abs(fine - 2.0 / 3.0) > 1e-10
+     || std::abs(coarse - 2.0 / 3.0) < 1e-6) {
+        std::cout << "testIntegrate limit " << coarse << " " << fine << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool
+testSeries()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    struct Check {
+        const char* expr;
+        double result;
+        double tolerance;
+    };
+    const double n = 3.0e6;     // more than one chunk
+    std::vector<Check> checks{
+         {"sum(i; i; 1; 100)", 5050.0, 0.0}
+        ,{"sum(i; i; 0.5; 3.5)", 6.0, 0.0}
+        ,{"sum(i; i; 3; 1)", 0.0, 0.0}
+        ,{"prod(i; i; 3; 1)", 1.0, 0.0}
+        ,{"prod(i; i; 1; 10)", 3628800.0, 0.0}
+        ,{"prod(1 + 1/i; i; 1; 999)", 1000.0, 1e-10}
+        // the partial product 1e400 is out of range
+        ,{"prod(1e200^(-(i - 2.5)/abs(i - 2.5)); i; 1; 4)", 1.0, 1e-14}
+        ,{"sum(0.1; i; 1; 1e7)", 1.0e6, 1e-9}
+        ,{"sum(1; i; 1; 3e6)", n, 0.0}
+        ,{"sum(1/i; i; 1; 3e6)", std::log(n) + std::numbers::egamma + 1.0 / (2.0 * n) - 1.0 / (12.0 * n * n), 1e-13}
+        ,{"sum(sum(j; j; 1; i); i; 1; 10)", 220.0, 0.0}
+    };
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        double result = evaluator->eval(syntax.parse(expr));
+        if (!(std::abs(result - check.result) <= check.tolerance)) {
+            std::cout << "testSeries " << check.expr << " got " << std::setprecision(17) << result
+                      << " expected " << check.result << std::endl;
+            return false;
+        }
+    }
+    Glib::ustring power{"sum(x^i; i; 0; 3)"};
+    auto program = evaluator->compile(syntax.parse(power), {"x"});
+    double x = 2.0;
+    if (evaluator->eval(program, std::span<const double>(&x, 1)) != 15.0) {
+        std::cout << "testSeries param " << evaluator->eval(program, std::span<const double>(&x, 1)) << std::endl;
+        return false;
+    }
+    for (auto fail : {"sum(i; i; 1; 1/0)", "prod(i; i; 0; 1e13)"}) {
+        Glib::ustring expr{fail};
+        try {
+            evaluator->eval(syntax.parse(expr));
+            std::cout << "testSeries no error for " << fail << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    return true;
+}
+
+bool
+hasOpCode(const PtrProgram& program, OpCode code)
+{
+    auto& instrs = program->get_code();
+    return std::any_of(instrs.begin(), instrs.end(), [code] (const Instruction& instr) {
+        return instr.code == code;
+    });
+}
+
+// definitions are compiled once, small ones are inlined at the call
+bool
+testUserFunctions()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    auto eval = [&] (const char* text) {
+        Glib::ustring expr{text};
+        return evaluator->eval(syntax.parse(expr));
+    };
+    eval("sq(x) = x^2");
+    eval("f(x; y) = x*y + 1");
+    eval("a = 3");
+    eval("g(t) = sin(t)/t + a*t^3 - t^4 + cos(2*t)*exp(-t) + sqrt(t + 10)");
+    struct Check {
+        const char* expr;
+        double result;
+    };
+    std::vector<Check> checks{
+         {"sq(3)", 9.0}
+        ,{"f(2; 3)", 7.0}
+        ,{"f(sq(2); 1 + 1)", 9.0}
+        ,{"g(1)", std::sin(1.0) + 3.0 - 1.0 + std::cos(2.0) * std::exp(-1.0) + std::sqrt(11.0)}
+        ,{"sum(sq(i); i; 1; 3)", 14.0}
+    };
+    for (auto& check : checks) {
+        double result = eval(check.expr);
+        if (std::abs(result - check.result) > 1e-12) {
+            std::cout << "testUserFunctions " << check.expr << " got " << result
+                      << " expected " << check.result << std::endl;
+            return false;
+        }
+    }
+    Glib::ustring small{"f(x; 2) + sq(x + 1)"};
+    auto program = evaluator->compile(syntax.parse(small), {"x"});
+    double x = 3.0;
+    if (hasOpCode(program, OpCode::Call)
+     || hasOpCode(program, OpCode::CallN)
+     || evaluator->eval(program, std::span<const double>(&x, 1)) != 23.0) {
+        std::cout << "testUserFunctions inline " << evaluator->eval(program, std::span<const double>(&x, 1)) << std::endl;
+        return false;
+    }
+    // the inlined body is folded with the arguments
+    Glib::ustring folded{"sq(3) + 1"};
+    program = evaluator->compile(syntax.parse(folded));
+    if (program->get_code().size() != 1
+     || program->get_code()[0].code != OpCode::Const
+     || program->get_code()[0].value != 10.0) {
+        std::cout << "testUserFunctions folded " << program->get_code().size() << std::endl;
+        return false;
+    }
+    Glib::ustring large{"g(x)"};
+    program = evaluator->compile(syntax.parse(large), {"x"});
+    std::vector<double> input{0.5, 1.0, 2.0};
+    std::vector<double> output(input.size());
+    evaluator->eval_batch(program, input, output);
+    for (size_t i = 0; i < input.size(); ++i) {
+        double t = input[i];
+        double expect = std::sin(t) / t + 3.0 * t * t * t - t * t * t * t + std::cos(2.0 * t) * std::exp(-t) + std::sqrt(t + 10.0);
+        if (!hasOpCode(program, OpCode::Call)
+         || std::abs(output[i] - expect) > 1e-12) {
+            std::cout << "testUserFunctions batch " << t << " got " << output[i] << " expected " << expect << std::endl;
+            return false;
+        }
+    }
+    Glib::ustring product{"f(x; x) + f(x; 1)"};
+    program = evaluator->compile(syntax.parse(product), {"x"});
+    EvalFrame frame(*evaluator);
+    Dual arg(3.0, 1.0);
+    auto derivative = frame.eval_dual(*program, std::span<const Dual>(&arg, 1));
+    if (std::abs(derivative.der - 7.0) > 1e-6) {
+        std::cout << "testUserFunctions derivative " << derivative.der << std::endl;
+        return false;
+    }
+    eval("sq(x) = x^3");
+    if (eval("sq(2)") != 8.0
+     || evaluator->get_user_functions().size() != 3) {
+        std::cout << "testUserFunctions redefinition " << eval("sq(2)") << std::endl;
+        return false;
+    }
+    for (auto fail : {"f(1)", "sq(1; 2)", "sin(x) = x", "h(x; x) = x"}) {
+        try {
+            eval(fail);
+            std::cout << "testUserFunctions no error for " << fail << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    return true;
+}
+
+// the builtin functions with more arguments
+bool
+testFunctionArgs()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    struct Check {
+        const char* expr;
+        double (*expect)(double x);
+    };
+    std::vector<Check> checks{
+         {"atan2(x; -1)", [] (double x) { return std::atan2(x, -1.0); }}
+        ,{"hypot(x; 1e300)", [] (double x) { return std::hypot(x, 1.0e300); }}
+        ,{"min(x; 2)", [] (double x) { return std::fmin(x, 2.0); }}
+        ,{"max(x; 2)", [] (double x) { return std::fmax(x, 2.0); }}
+        ,{"pow(x; 1.5)", [] (double x) { return std::pow(x, 1.5); }}
+        ,{"fma(x; x; -9)", [] (double x) { return std::fma(x, x, -9.0); }}
+        ,{"clamp(x; 1; 3)", [] (double x) { return std::fmin(std::fmax(x, 1.0), 3.0); }}
+        ,{"logb(x; 2)", [] (double x) { return std::log(x) / std::log(2.0); }}
+    };
+    std::vector<double> input{0.5, 1.0, 2.5, 3.0, 4.0};
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        auto program = evaluator->compile(syntax.parse(expr), {"x"});
+        std::vector<double> output(input.size());
+        evaluator->eval_batch(program, input, output);
+        for (size_t i = 0; i < input.size(); ++i) {
+            double x = input[i];
+            double single = evaluator->eval(program, std::span<const double>(&x, 1));
+            if (single != check.expect(x)
+             || output[i] != check.expect(x)) {
+                std::cout << "testFunctionArgs " << check.expr << " x " << x << " got " << single
+                          << " batch " << output[i] << " expected " << check.expect(x) << std::endl;
+                return false;
+            }
+        }
+        EvalFrame frame(*evaluator);
+        double x = 2.5;
+        double step = 1e-6;
+        Dual arg(x, 1.0);
+        double der = frame.eval_dual(*program, std::span<const Dual>(&arg, 1)).der;
+        double diff = (check.expect(x + step) - check.expect(x - step)) / (2.0 * step);
+        if (std::abs(der - diff) > 1e-6 * std::max(std::abs(diff), 1.0)) {
+            std::cout << "testFunctionArgs " << check.expr << " derivative " << der << " expected " << diff << std::endl;
+            return false;
+        }
+        Interval domain(1.0, 4.0);
+        Interval range = frame.eval_interval(*program, std::span<const Interval>(&domain, 1));
+        for (double x : input) {
+            if (domain.contains(x)
+             && !range.contains(check.expect(x))) {
+                std::cout << "testFunctionArgs " << check.expr << " enclosure misses " << x << std::endl;
+                return false;
+            }
+        }
+    }
+    Glib::ustring folded{"fma(2; 3; 4) + logb(8; 2)"};
+    auto program = evaluator->compile(syntax.parse(folded));
+    if (program->get_code().size() != 1
+     || evaluator->eval(program) != 13.0) {
+        std::cout << "testFunctionArgs folded " << evaluator->eval(program) << std::endl;
+        return false;
+    }
+    for (auto fail : {"hypot(1)", "fma(1; 2)", "pow(1; 2; 3)"}) {
+        Glib::ustring expr{fail};
+        try {
+            evaluator->eval(syntax.parse(expr));
+            std::cout << "testFunctionArgs no error for " << fail << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    // the single argument entry is not for these
+    FunctionHypot hypot;
+    try {
+        hypot.eval(1.0, nullptr);
+        std::cout << "testFunctionArgs no error for a single argument" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// list values are evaluated element wise and reduced
+bool
+testLists()
+{
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    auto eval = [&] (const std::string& text) {
+        Glib::ustring expr{text};
+        return evaluator->eval(syntax.parse(expr));
+    };
+    if (eval("data = [1; 2; 3; 4]") != 4.0) {
+        std::cout << "testLists assign count " << eval("data = [1; 2; 3; 4]") << std::endl;
+        return false;
+    }
+    eval("a = 3");
+    eval("c = 2*data + 1");
+    struct Check {
+        const char* expr;
+        double result;
+    };
+    std::vector<Check> checks{
+         {"sum(data)", 10.0}
+        ,{"mean(data)", 2.5}
+        ,{"stddev(data)", std::sqrt(5.0 / 3.0)}
+        ,{"min(data)", 1.0}
+        ,{"max(data)", 4.0}
+        ,{"norm(data)", std::sqrt(30.0)}
+        ,{"norm([3e200; 4e200])", 5e200}
+        ,{"dot(data; data)", 30.0}
+        ,{"dot(data; [1; 0; 0; 1])", 5.0}
+        ,{"sum(c)", 24.0}
+        ,{"sum((data - mean(data))^2)", 5.0}
+        ,{"sum([a; a*2])", 9.0}
+        ,{"sum(min(data; 2))", 7.0}
+        ,{"sum(sqrt(data^2))", 10.0}
+        ,{"sum(data*[2])", 20.0}
+        ,{"sum(3)", 3.0}
+        ,{"sum([])", 0.0}
+        ,{"sum(sum(i*data); i; 1; 2)", 30.0}
+    };
+    for (auto& check : checks) {
+        double result = eval(check.expr);
+        if (std::abs(result - check.result) > 1e-12 * std::max(1.0, std::abs(check.result))) {
+            std::cout << "testLists " << check.expr << " got " << result
+                      << " expected " << check.result << std::endl;
+            return false;
+        }
+    }
+    // more than one batch block, pairwise summation keeps the error small
+    std::string many{"big = ["};
+    const size_t count = 100000;
+    for (size_t i = 0; i < count; ++i) {
+        many += i > 0 ? "; 0.1" : "0.1";
+    }
+    eval(many + "]");
+    if (std::abs(eval("sum(big*2)") - 2.0e4) > 1e-9
+     || std::abs(eval("mean(big)") - 0.1) > 1e-15) {
+        std::cout << "testLists big " << std::setprecision(17) << eval("sum(big*2)") << std::endl;
+        return false;
+    }
+    Glib::ustring scaled{"x*mean(data) + sum(data*x)"};
+    auto program = evaluator->compile(syntax.parse(scaled), {"x"});
+    std::vector<double> input{1.0, 2.0, 3.0};
+    std::vector<double> output(input.size());
+    evaluator->eval_batch(program, input, output);
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (output[i] != 12.5 * input[i]) {
+            std::cout << "testLists batch " << input[i] << " got " << output[i] << std::endl;
+            return false;
+        }
+    }
+    EvalFrame frame(*evaluator);
+    Dual arg(2.0, 1.0);
+    auto derivative = frame.eval_dual(*program, std::span<const Dual>(&arg, 1));
+    if (std::abs(derivative.der - 12.5) > 1e-6) {
+        std::cout << "testLists derivative " << derivative.der << std::endl;
+        return false;
+    }
+    for (auto fail : {"data + 1", "[1; 2]", "sum(i*data; i; 1; 2)", "e = [1; 2] + [1; 2; 3]", "mean(data; data)", "mean(x) = x"}) {
+        try {
+            eval(fail);
+            std::cout << "testLists no error for " << fail << std::endl;
+            return false;
+        }
+        catch (const EvalError& err) {
+        }
+    }
+    eval("data = 5");
+    if (eval("data + 1") != 6.0) {
+        std::cout << "testLists value again " << eval("data + 1") << std::endl;
+        return false;
+    }
+    auto version = evaluator->get_compile_version();     // e.g. to drop cached programs
+    eval("data = [1; 2]");
+    if (evaluator->get_compile_version() == version) {
+        std::cout << "testLists compile version unchanged" << std::endl;
+        return false;
+    }
+    // as saved and restored with the variables
+    auto lists = evaluator->get_list_map();
+    if (lists.size() != 3          // with big
+     || lists["data"] != std::vector<double>{1.0, 2.0}
+     || evaluator->get_variable_map().contains("data")) {
+        std::cout << "testLists list map " << lists.size() << std::endl;
+        return false;
+    }
+    evaluator->set_list("restored", std::move(lists["c"]));
+    if (eval("sum(restored)") != 24.0) {
+        std::cout << "testLists restored " << eval("sum(restored)") << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// constant parts are folded, and operations replaced by cheaper ones
+bool
+testOptimize()
+{
+    auto testEval = std::make_shared<TestEval>();
+    auto testFormat = std::make_shared<TestFormat>();
+    Syntax syntax(testFormat, testEval);
+    testEval->set_constant("pi", G_PI);
+    testEval->set_variable("r", 2.0);
+    Glib::ustring circ{"2*pi*r"};
+    auto program = testEval->compile(syntax.parse(circ));
+    if (program->get_code().size() != 3
+     || testEval->eval(program) != 2.0 * G_PI * 2.0) {
+        std::cout << "testOptimize " << circ << " size " << program->get_code().size() << std::endl;
+        return false;
+    }
+    struct Check {
+        const char* expr;
+        OpCode removed;
+        double (*expect)(double x);
+    };
+    std::vector<Check> checks{
+         {"x^2 + 3^4", OpCode::Pow, [] (double x) { return std::pow(x, 2.0) + 81.0; }}
+        ,{"x^3 - x^-3", OpCode::Pow, [] (double x) { return std::pow(x, 3.0) - std::pow(x, -3.0); }}
+        ,{"x^7", OpCode::Pow, [] (double x) { return std::pow(x, 7.0); }}
+        ,{"x/4", OpCode::Div, [] (double x) { return x / 4.0; }}
+        ,{"--x", OpCode::Neg, [] (double x) { return x; }}
+        ,{"3 - -x", OpCode::Neg, [] (double x) { return 3.0 + x; }}
+    };
+    std::vector<double> in{-2.5, -1.0, 0.0, 0.3, 1.7, 10.0};
+    std::vector<double> out(in.size());
+    for (auto& check : checks) {
+        Glib::ustring expr{check.expr};
+        auto param = testEval->compile(syntax.parse(expr), {"x"});
+        if (hasOpCode(param, check.removed)) {
+            std::cout << "testOptimize " << check.expr << " not optimized" << std::endl;
+            return false;
+        }
+        testEval->eval_batch(param, in, out);
+        for (size_t i = 0; i < in.size(); ++i) {
+            double expect = check.expect(in[i]);
+            double res = testEval->eval(param, std::span<const double>(&in[i], 1));
+            if (std::abs(res - expect) > std::abs(expect) * VALUE_LIMIT
+             || std::abs(out[i] - expect) > std::abs(expect) * VALUE_LIMIT) {
+                std::cout << "testOptimize " << check.expr << " x " << in[i]
+                          << " got " << res << " batch " << out[i] << " expected " << expect << std::endl;
+                return false;
+            }
+        }
+    }
+    Glib::ustring div{"x/3"};
+    auto third = testEval->compile(syntax.parse(div), {"x"});
+    if (!hasOpCode(third, OpCode::Div)) {     // 1/3 is not exact
+        std::cout << "testOptimize x/3 replaced" << std::endl;
+        return false;
+    }
+    try {
+        Glib::ustring assign{"pi=3"};
+        testEval->compile(syntax.parse(assign));
+        std::cout << "testOptimize no error for assignment to constant" << std::endl;
+        return false;
+    }
+    catch (const EvalError& err) {
+    }
+    return true;
+}
+
+// difference in units of the last place
+double
+ulp_diff(double val, double expect)
+{
+    if (val == expect || (std::isnan(val) && std::isnan(expect))) {
+        return 0.0;
+    }
+    double ulp = std::nextafter(std::abs(expect), INFINITY) - std::abs(expect);
+    return std::abs(val - expect) / ulp;
+}
+
+bool
+testVectorMath()
+{
+    using Kernel = std::function<void(std::span<const double>, std::span<double>)>;
+    struct Check {
+        const char* name;
+        double min;
+        double max;
+        Kernel kernel;
+        double (*libm)(double);
+        double maxUlp;
+    };
+    std::vector<Check> checks{
+         {"exp", -745.0, 710.0, [] (auto in, auto out) { VectorMath::exp(in, out); }
+            , [] (double v) { return std::exp(v); }, 1.0}
+        ,{"log", 0.0, 1e6, [] (auto in, auto out) { VectorMath::log(in, out); }
+            , [] (double v) { return std::log(v); }, 1.0}
+        ,{"log2", 0.0, 4.0, [] (auto in, auto out) { VectorMath::log2(in, out); }
+            , [] (double v) { return std::log2(v); }, 2.0}
+        ,{"log10", 0.0, 4.0, [] (auto in, auto out) { VectorMath::log10(in, out); }
+            , [] (double v) { return std::log10(v); }, 2.0}
+        ,{"cbrt", -1e9, 1e9, [] (auto in, auto out) { VectorMath::cbrt(in, out); }
+            , [] (double v) { return std::cbrt(v); }, 3.0}
+        ,{"sin", -1000.0, 1000.0, [] (auto in, auto out) { VectorMath::sin(in, out); }
+            , [] (double v) { return std::sin(v); }, 2.0}
+        ,{"cos", -1000.0, 1000.0, [] (auto in, auto out) { VectorMath::cos(in, out); }
+            , [] (double v) { return std::cos(v); }, 2.0}
+        ,{"tan", -1000.0, 1000.0, [] (auto in, auto out) { VectorMath::tan(in, out); }
+            , [] (double v) { return std::tan(v); }, 4.0}
+        ,{"asin", -1.0, 1.0, [] (auto in, auto out) { VectorMath::asin(in, out); }
+            , [] (double v) { return std::asin(v); }, 3.0}
+        ,{"acos", -1.0, 1.0, [] (auto in, auto out) { VectorMath::acos(in, out); }
+            , [] (double v) { return std::acos(v); }, 3.0}
+        ,{"atan", -100.0, 100.0, [] (auto in, auto out) { VectorMath::atan(in, out); }
+            , [] (double v) { return std::atan(v); }, 3.0}
+    };
+    std::vector<double> in(100003);     // not a multiple of the block
+    std::vector<double> out(in.size());
+    for (auto& check : checks) {
+        uint64_t seed{42};
+        for (auto& val : in) {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            val = check.min + (check.max - check.min) * static_cast<double>(seed >> 11) * 0x1p-53;
+        }
+        check.kernel(in, out);
+        for (size_t i = 0; i < in.size(); ++i) {
+            if (ulp_diff(out[i], check.libm(in[i])) > check.maxUlp) {
+                std::cout << "testVectorMath " << check.name << "(" << std::setprecision(17) << in[i] << ")"
+                          << " got " << out[i] << " expected " << check.libm(in[i]) << std::endl;
+                return false;
+            }
+        }
+    }
+    // special values are left to libm
+    std::vector<double> special{0.0, INFINITY, -INFINITY, NAN, 1e-310, 800.0, -800.0};
+    VectorMath::exp(special, out);
+    for (size_t i = 0; i < special.size(); ++i) {
+        if (ulp_diff(out[i], std::exp(special[i])) > 0.0) {
+            std::cout << "testVectorMath exp(" << special[i] << ") got " << out[i] << std::endl;
+            return false;
+        }
+    }
+    // degree are reduced exactly
+    std::vector<double> degree{0.0, 90.0, 180.0, 270.0, 360.0 * 1000.0 + 30.0};
+    std::vector<double> expect{0.0, 1.0, 0.0, -1.0, 0.5};
+    VectorMath::sin(degree, out, 90.0);
+    for (size_t i = 0; i < degree.size(); ++i) {
+        if (std::abs(out[i] - expect[i]) > 1e-16) {
+            std::cout << "testVectorMath sin(" << degree[i] << "°) got " << out[i] << std::endl;
+            return false;
+        }
+    }
+    // a plot and a single value agree, also for the sign of zeros and the poles
+    auto evaluator = std::make_shared<Evaluator>();
+    Syntax syntax(evaluator->get_output_format(), evaluator);
+    std::vector<double> angles{-0.0};
+    for (int i = -8; i <= 8; ++i) {
+        angles.push_back(i);
+    }
+    std::vector<double> batch(angles.size());
+    for (auto unit : {"deg", "gon"}) {
+        evaluator->set_angle_conv(AngleConversion::get_conversion(unit));
+        double rightAngle = evaluator->get_right_angle();
+        std::vector<double> multiples;
+        for (auto angle : angles) {
+            multiples.push_back(angle * rightAngle);
+        }
+        for (auto text : {"sin(x)", "cos(x)", "tan(x)"}) {
+            Glib::ustring expr{text};
+            auto program = evaluator->compile(syntax.parse(expr), {"x"});
+            evaluator->eval_batch(program, multiples, batch);
+            for (size_t i = 0; i < multiples.size(); ++i) {
+                double single = evaluator->eval(program, std::span<const double>(&multiples[i], 1));
+                if (std::bit_cast<uint64_t>(single) != std::bit_cast<uint64_t>(batch[i])) {
+                    std::cout << "testVectorMath " << text << " " << unit << " at " << multiples[i]
+                              << " single " << single << " batch " << batch[i] << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 bool
 testLen(Dimensions& dims)
 {
@@ -310,6 +1708,75 @@ int main(int argc, char** argv)
     if (!testTupl()) {
         return 10;
     }
+    if (!testCompile()) {
+        return 11;
+    }
+    if (!testVariables()) {
+        return 12;
+    }
+    if (!testParams()) {
+        return 13;
+    }
+    if (!testBatch()) {
+        return 14;
+    }
+    if (!testVectorMath()) {
+        return 15;
+    }
+    if (!testOptimize()) {
+        return 16;
+    }
+    if (!testLexer()) {
+        return 17;
+    }
+    if (!testParser()) {
+        return 18;
+    }
+    if (!testEvaluator()) {
+        return 19;
+    }
+    if (!testBatchEval()) {
+        return 20;
+    }
+    if (!testEvalSession()) {
+        return 21;
+    }
+    if (!testFrames()) {
+        return 22;
+    }
+    if (!testPlotSampler()) {
+        return 23;
+    }
+    if (!testAdaptiveSampling()) {
+        return 24;
+    }
+    if (!testSampleTiles()) {
+        return 25;
+    }
+    if (!testInterval()) {
+        return 26;
+    }
+    if (!testDual()) {
+        return 27;
+    }
+    if (!testSolve()) {
+        return 28;
+    }
+    if (!testIntegrate()) {
+        return 29;
+    }
+    if (!testSeries()) {
+        return 30;
+    }
+    if (!testUserFunctions()) {
+        return 31;
+    }
+    if (!testFunctionArgs()) {
+        return 32;
+    }
+    if (!testLists()) {
+        return 33;
+    }
     return 0;
 }
 
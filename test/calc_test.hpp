@@ -22,10 +22,35 @@
 #include <charconv>
 #include <optional>
 #include <system_error>
+#include <atomic>
+#include <algorithm>
 
 #include "BaseEval.hpp"
 #include "NumberFormat.hpp"
 
+// identity that counts the evaluated arguments
+class FunctionCount
+: public Function
+{
+public:
+    double eval(double argument, EvalFrame* frame) override
+    {
+        ++m_count;
+        return argument;
+    }
+    void eval_batch(std::span<const double> in, std::span<double> out, EvalFrame* frame) override
+    {
+        m_count += in.size();
+        std::copy(in.begin(), in.end(), out.begin());
+    }
+    size_t get_count() const
+    {
+        return m_count;
+    }
+private:
+    std::atomic<size_t> m_count{};
+};
+
 class TestEval
 : public BaseEval
 {
@@ -36,25 +61,21 @@ public:
     // provide a minimal set of these functions
     std::shared_ptr<Function> getFunction(const Glib::ustring& name) override
     {
+        if (name == "sqrt") {
+            return m_sqrt;
+        }
+        if (name == "count") {
+            return m_count;
+        }
         return std::shared_ptr<Function>();
     }
-    bool get_variable(const Glib::ustring& name, double* val) override
-    {
-        *val = 0.0;
-        return false;
-    }
-    void set_variable(const Glib::ustring& name, double val) override
+    size_t get_count() const
     {
+        return m_count->get_count();
     }
-    double toRadian(double val) override
-    {
-        return val;
-    }
-    double fromRadian(double val) override
-    {
-        return val;
-    }
-
+private:
+    std::shared_ptr<Function> m_sqrt{std::make_shared<FunctionSqrt>()};
+    std::shared_ptr<FunctionCount> m_count{std::make_shared<FunctionCount>()};
 };
 
 // parses double locale independent
@@ -65,11 +86,11 @@ public:
     TestFormat() = default;
     virtual ~TestFormat() = default;
 
-    bool parse(const Glib::ustring& remain, double& value, std::string::size_type* offs) const override
+    bool parse(std::string_view remain, double& value, std::string::size_type* offs) const override
     {
         double result{};
-        auto cstr = remain.c_str();
-        auto cend = cstr + remain.bytes();
+        auto cstr = remain.data();
+        auto cend = cstr + remain.size();
         auto [ptr, ec] = std::from_chars(cstr, cend, result);
         if (ec == std::errc()) {
             *offs = static_cast<std::string::size_type>(std::distance(cstr, ptr));
@@ -81,3 +102,20 @@ public:
     }
 
 };
+
+// parses with the locale code, but a fixed decimal point
+class CommaFormat
+: public NumberFormat
+{
+public:
+    CommaFormat()
+    : NumberFormat(",")
+    {
+    }
+    virtual ~CommaFormat() = default;
+
+    bool parse(std::string_view remain, double& value, std::string::size_type* offs) const override
+    {
+        return parse_decimal(remain, value, offs);
+    }
+};